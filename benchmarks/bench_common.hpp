@@ -0,0 +1,77 @@
+#pragma once
+
+#include "node.hpp"
+#include "solution.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Instances resemble the course ones: coordinates and weights drawn uniformly.
+inline Nodes generateInstance(int size, unsigned int seed = 42)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coord(0, 4000);
+    std::uniform_int_distribution<int> weight(0, 2000);
+    Nodes nodes;
+    nodes.reserve(size);
+    for (int i = 0; i < size; ++i)
+    {
+        int x = coord(rng);
+        int y = coord(rng);
+        nodes.emplace_back(x, y, weight(rng));
+    }
+    return nodes;
+}
+
+inline Solution generateRandomSolution(int num_nodes, int size, unsigned int seed = 42)
+{
+    std::mt19937 rng(seed);
+    Solution solution(num_nodes);
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        solution[i] = i;
+    }
+    std::shuffle(solution.begin(), solution.end(), rng);
+    solution.resize(size);
+    return solution;
+}
+
+inline std::vector<int> benchmarkSizes(int argc, char **argv, std::vector<int> defaults)
+{
+    if (argc < 2)
+    {
+        return defaults;
+    }
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; ++i)
+    {
+        sizes.push_back(std::atoi(argv[i]));
+    }
+    return sizes;
+}
+
+class Stopwatch
+{
+public:
+    Stopwatch() : m_start(std::chrono::high_resolution_clock::now()) {}
+
+    double seconds() const
+    {
+        const auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - m_start).count();
+    }
+
+private:
+    std::chrono::high_resolution_clock::time_point m_start;
+};
+
+// Keeps the optimizer from discarding benchmarked computations.
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
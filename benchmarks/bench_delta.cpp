@@ -0,0 +1,106 @@
+#include "bench_common.hpp"
+#include "delta.hpp"
+
+#include <iostream>
+#include <numeric>
+
+// Reference layout the flat matrix replaced: one heap block per row.
+typedef std::vector<std::vector<int>> NestedMatrix;
+
+static int nestedEdgesSwapDelta(const NestedMatrix &dist, const Solution &solution, int first_idx, int second_idx)
+{
+    int first = solution[first_idx];
+    int first_next = solution[(first_idx + 1) % solution.size()];
+    int second = solution[second_idx];
+    int second_next = solution[(second_idx + 1) % solution.size()];
+    return dist[first][second] + dist[first_next][second_next] - dist[first][first_next] - dist[second][second_next];
+}
+
+static int nestedReplaceNodeDelta(const NestedMatrix &dist, const Nodes &nodes, const Solution &solution, int sol_idx, int node_idx)
+{
+    int prev = solution[(sol_idx - 1 + solution.size()) % solution.size()];
+    int next = solution[(sol_idx + 1) % solution.size()];
+    int current = solution[sol_idx];
+    return dist[prev][node_idx] + dist[node_idx][next] + nodes[node_idx].getWeight() - nodes[current].getWeight() - dist[prev][current] - dist[current][next];
+}
+
+template <typename Evaluate>
+static void run(const std::string &label, const Solution &solution, int num_nodes, Evaluate evaluate)
+{
+    long long evaluations = 0;
+    long long checksum = 0;
+    Stopwatch stopwatch;
+    while (stopwatch.seconds() < 0.5)
+    {
+        for (int i = 0; i < solution.size(); ++i)
+        {
+            for (int j = i + 2; j < solution.size(); ++j)
+            {
+                checksum += evaluate(true, i, j);
+            }
+            for (int k = 0; k < num_nodes; k += 2)
+            {
+                checksum += evaluate(false, i, k);
+            }
+        }
+        evaluations += (solution.size() * (solution.size() - 1)) / 2 + solution.size() * ((num_nodes + 1) / 2);
+    }
+    doNotOptimize(checksum);
+    std::cout << label << '\t' << evaluations / stopwatch.seconds() / 1e6 << " M deltas/s\n";
+}
+
+static void runBatched(const std::string &label, const NodesDistPair &nodes, const Solution &solution)
+{
+    const int num_nodes = nodes.nodes.size();
+    std::vector<int> positions(solution.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    std::vector<int> replacements;
+    for (int k = 0; k < num_nodes; k += 2)
+    {
+        replacements.push_back(k);
+    }
+
+    long long evaluations = 0;
+    long long checksum = 0;
+    Stopwatch stopwatch;
+    while (stopwatch.seconds() < 0.5)
+    {
+        for (int i = 0; i < solution.size(); ++i)
+        {
+            int count = std::max<int>(solution.size() - i - 2, 0);
+            checksum += minEdgesSwapDelta(nodes, solution, i, positions.data() + i + 2, count).delta;
+            checksum += minReplaceNodeDelta(nodes, solution, i, replacements.data(), replacements.size()).delta;
+        }
+        evaluations += (solution.size() * (solution.size() - 1)) / 2 + solution.size() * ((num_nodes + 1) / 2);
+    }
+    doNotOptimize(checksum);
+    std::cout << label << (batchKernelsUseAvx2() ? " (avx2)" : " (scalar)") << '\t'
+              << evaluations / stopwatch.seconds() / 1e6 << " M deltas/s\n";
+}
+
+int main(int argc, char **argv)
+{
+    for (int size : benchmarkSizes(argc, argv, {200, 2000, 8000}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        Solution solution = generateRandomSolution(size, size / 2);
+
+        NestedMatrix nested(size, std::vector<int>(size));
+        for (int i = 0; i < size; ++i)
+        {
+            for (int j = 0; j < size; ++j)
+            {
+                nested[i][j] = nodes.dist[i][j];
+            }
+        }
+
+        std::cout << "n = " << size << '\n';
+        run("  nested", solution, size, [&](bool edge, int i, int j)
+            { return edge ? nestedEdgesSwapDelta(nested, solution, i, j)
+                          : nestedReplaceNodeDelta(nested, nodes.nodes, solution, i, j); });
+        run("  flat", solution, size, [&](bool edge, int i, int j)
+            { return edge ? getEdgesSwapDelta(nodes, solution, i, j)
+                          : getReplaceNodeDelta(nodes, solution, i, j); });
+        runBatched("  batched", nodes, solution);
+    }
+}
@@ -0,0 +1,39 @@
+#include "bench_common.hpp"
+#include "improvers.hpp"
+
+#include <iostream>
+
+// Time to a local optimum from a random half-size tour. The candidate improver is
+// quadratic per descent, so it only runs on the smaller instances.
+int main(int argc, char **argv)
+{
+    const int num_candidates = 10;
+    for (int size : benchmarkSizes(argc, argv, {1000, 2000, 5000, 10000, 20000}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        Solution start = generateRandomSolution(size, size / 2);
+        std::cout << "n = " << size << std::endl;
+
+        Stopwatch lists_time;
+        getCandidateLists(nodes.nodes, num_candidates);
+        std::cout << "  candidate lists\t" << lists_time.seconds() << " s" << std::endl;
+
+        Solution solution = start;
+        DontLookBitsImprover improver(NeighborhoodType::EDGE, num_candidates);
+        Stopwatch bits_time;
+        improver.improve(solution, nodes);
+        double seconds = bits_time.seconds();
+        std::cout << "  don't-look bits\t" << seconds << " s\t" << seconds / size * 1e6 << " us/node\tcost "
+                  << evaluateSolution(nodes.nodes, solution) << std::endl;
+
+        if (size <= 2000)
+        {
+            solution = start;
+            SteepestCandidateImprover candidate(NeighborhoodType::EDGE, num_candidates);
+            Stopwatch candidate_time;
+            candidate.improve(solution, nodes);
+            std::cout << "  candidate steepest\t" << candidate_time.seconds() << " s\tcost "
+                      << evaluateSolution(nodes.nodes, solution) << std::endl;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#include "bench_common.hpp"
+#include "improvers.hpp"
+
+#include <iostream>
+
+// Previous encoding: 2 bits of type and 15 bits per index packed into an int.
+constexpr static unsigned int OLD_VAL_BITS = 15;
+constexpr static unsigned int OLD_TYPE_MASK = 0b11 << (OLD_VAL_BITS * 2);
+constexpr static unsigned int OLD_FIRST_VAL_MASK = ((1 << OLD_VAL_BITS) - 1) << OLD_VAL_BITS;
+constexpr static unsigned int OLD_SECOND_VAL_MASK = ~(OLD_TYPE_MASK | OLD_FIRST_VAL_MASK);
+
+static int encodeOld(const OpData &op)
+{
+    return (static_cast<int>(op.m_type) << (OLD_VAL_BITS * 2)) | (op.m_first_idx << OLD_VAL_BITS) | op.m_second_idx;
+}
+
+static OpData decodeOld(int operation)
+{
+    return OpData(
+        static_cast<OperationType>((operation & OLD_TYPE_MASK) >> (OLD_VAL_BITS * 2)),
+        (operation & OLD_FIRST_VAL_MASK) >> OLD_VAL_BITS,
+        operation & OLD_SECOND_VAL_MASK);
+}
+
+template <typename Packed, typename Decode>
+static void run(const std::string &label, const std::vector<Packed> &operations, const Solution &solution, const NodesDistPair &nodes, Decode decode)
+{
+    long long evaluated = 0;
+    int best_delta = 0;
+    Stopwatch stopwatch;
+    while (stopwatch.seconds() < 1.0)
+    {
+        for (Packed operation : operations)
+        {
+            int delta = decode(operation).evaluate(solution, nodes);
+            if (delta < best_delta)
+            {
+                best_delta = delta;
+            }
+        }
+        evaluated += operations.size();
+    }
+    doNotOptimize(best_delta);
+    std::cout << "  " << label << '\t' << sizeof(Packed) << " B/move\t"
+              << operations.size() * sizeof(Packed) / 1e6 << " MB\t"
+              << evaluated / stopwatch.seconds() / 1e6 << " M moves/s" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    for (int size : benchmarkSizes(argc, argv, {200, 2000, 8000}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        Solution solution = generateRandomSolution(size, size / 2);
+        std::vector<Operation> operations = getNeighborhoodOperations(solution, size, NeighborhoodType::BOTH);
+        std::vector<int> old_operations(operations.size());
+        for (std::size_t i = 0; i < operations.size(); ++i)
+        {
+            old_operations[i] = encodeOld(OpData(operations[i]));
+        }
+
+        std::cout << "n = " << size << ", " << operations.size() << " moves" << std::endl;
+        run("32-bit", old_operations, solution, nodes, decodeOld);
+        run("64-bit", operations, solution, nodes, [](Operation operation)
+            { return OpData(operation); });
+    }
+}
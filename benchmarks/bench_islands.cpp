@@ -0,0 +1,39 @@
+#include "bench_common.hpp"
+#include "improvers.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Genetic local search ('e' and 'a' recombination) for the same wall-clock time with
+// 1..N islands, N being the hardware threads but at least 4. Iterations count the
+// children produced over all islands.
+int main(int argc, char **argv)
+{
+    const double time_limit = 2e6;
+    const int elite_size = 20;
+    const int max_islands = std::max(4u, std::thread::hardware_concurrency());
+    for (int size : benchmarkSizes(argc, argv, {200}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        Solution start = generateRandomSolution(size, size / 2);
+        std::cout << "n = " << size << ", " << time_limit / 1e6 << " s per run" << std::endl;
+
+        Rng rng;
+        for (char variant : {'e', 'a'})
+        {
+            for (int num_islands = 1; num_islands <= max_islands; ++num_islands)
+            {
+                Solution solution = start;
+                auto improver = createImprover(variant, NeighborhoodType::EDGE, 0, rng, 'p', time_limit, elite_size, num_islands);
+                Stopwatch time;
+                solution = improver->improve(solution, nodes);
+                double seconds = time.seconds();
+                std::cout << "  " << variant << ' ' << num_islands << " islands\t"
+                          << std::stoi(improver->additionalInfo()) / seconds << " iterations/s\tcost "
+                          << evaluateSolution(nodes.nodes, solution) << std::endl;
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include "bench_common.hpp"
+#include "improvers.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+// Multiple start greedy descent with the restarts spread over 1..N threads, N being
+// the hardware threads but at least 4. Every run has to return the tour of the
+// sequential one. Times are the best of a few runs; with fewer hardware threads than
+// pool threads they only show the pool's overhead.
+int main(int argc, char **argv)
+{
+    const int repeats = 32;
+    const int runs = 3;
+    const int max_threads = std::max(4u, std::thread::hardware_concurrency());
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    for (int size : benchmarkSizes(argc, argv, {200, 500}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        Solution start(size / 2);
+        std::cout << "n = " << size << std::endl;
+
+        Solution reference;
+        double single_time = 0.0;
+        Rng rng;
+        for (int num_threads = 1; num_threads <= max_threads; ++num_threads)
+        {
+            MultipleStartImprover improver(NeighborhoodType::BOTH, 'g', 0, rng, 0, repeats, num_threads);
+            Solution solution;
+            double seconds = 0.0;
+            for (int run = 0; run < runs; ++run)
+            {
+                solution = start;
+                Stopwatch time;
+                solution = improver.improve(solution, nodes);
+                seconds = run == 0 ? time.seconds() : std::min(seconds, time.seconds());
+            }
+            if (num_threads == 1)
+            {
+                reference = solution;
+                single_time = seconds;
+            }
+            std::cout << "  " << num_threads << " threads\t" << repeats / seconds << " restarts/s\tspeedup "
+                      << single_time / seconds << (solution == reference ? "\tsame tour" : "\tDIFFERENT TOUR") << std::endl;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#include "bench_common.hpp"
+#include "improvers.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+// Steepest descent over a materialized move vector, as before the move cache and the row scan.
+static Solution materializedSteepest(Solution solution, const NodesDistPair &nodes, NeighborhoodType type, std::size_t &bytes, int &steps, int &tied_steps)
+{
+    std::vector<Operation> operations = getNeighborhoodOperations(solution, nodes.nodes.size(), type);
+    bytes = operations.size() * sizeof(Operation);
+    steps = 0;
+    tied_steps = 0;
+    while (true)
+    {
+        int best_delta = 0;
+        int num_best = 0;
+        OpData best_op(OperationType::FORBIDDEN, 0, 0);
+        for (Operation operation : operations)
+        {
+            OpData op(operation);
+            int delta = op.evaluate(solution, nodes);
+            if (delta < best_delta)
+            {
+                best_delta = delta;
+                best_op = op;
+                num_best = 1;
+            }
+            else if (delta == best_delta && delta < 0)
+            {
+                ++num_best;
+            }
+        }
+        if (best_op.isInvalid())
+        {
+            break;
+        }
+        ++steps;
+        tied_steps += num_best > 1;
+        if (best_op.m_type == OperationType::NODE_REPLACE)
+        {
+            int old_node = solution[best_op.m_first_idx];
+            for (Operation &operation : operations)
+            {
+                OpData op(operation);
+                if (op.m_type == OperationType::NODE_REPLACE && op.m_second_idx == best_op.m_second_idx)
+                {
+                    operation = OpData(OperationType::NODE_REPLACE, op.m_first_idx, old_node).toInt();
+                }
+            }
+        }
+        best_op.apply(solution);
+    }
+    return solution;
+}
+
+// Tours are compared as cycles, the tour state may rotate or reverse them.
+static bool sameCycle(Solution first, const Solution &second)
+{
+    if (first.size() != second.size())
+    {
+        return false;
+    }
+    for (int reversed = 0; reversed < 2; ++reversed)
+    {
+        auto start = std::find(first.begin(), first.end(), second.front());
+        if (start == first.end())
+        {
+            return false;
+        }
+        std::rotate(first.begin(), start, first.end());
+        if (first == second)
+        {
+            return true;
+        }
+        std::reverse(first.begin(), first.end());
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    for (int size : benchmarkSizes(argc, argv, {200, 500, 1000}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        Solution start = generateRandomSolution(size, size / 2);
+        std::cout << "n = " << size << std::endl;
+
+        std::size_t bytes = 0;
+        int steps = 0;
+        int tied_steps = 0;
+        Stopwatch materialized_time;
+        Solution expected = materializedSteepest(start, nodes, NeighborhoodType::BOTH, bytes, steps, tied_steps);
+        std::cout << "  materialized\t" << materialized_time.seconds() << " s\t" << bytes / 1e6 << " MB of moves\t"
+                  << tied_steps << " of " << steps << " steps with tied moves" << std::endl;
+
+        // the move cache and the full scan pick the same moves, but they see positions of a
+        // tour reversed on its shorter side, so they do not visit tied moves in the order of
+        // the materialized scan and after a tied step they may end in another local optimum
+        for (bool full_scan : {false, true})
+        {
+            Solution solution = start;
+            SteepestImprover improver(NeighborhoodType::BOTH, 1, full_scan);
+            Stopwatch time;
+            improver.improve(solution, nodes);
+            std::cout << (full_scan ? "  full scan\t" : "  move cache\t") << time.seconds() << " s\tsame tour "
+                      << sameCycle(solution, expected) << "\tcost " << evaluateSolution(nodes.nodes, solution)
+                      << " vs " << evaluateSolution(nodes.nodes, expected) << std::endl;
+        }
+    }
+}
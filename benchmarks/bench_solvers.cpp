@@ -0,0 +1,56 @@
+#include "bench_common.hpp"
+#include "solvers.hpp"
+
+#include <iostream>
+
+// Exhaustive constructors are cubic, above this size they are only run on request.
+constexpr static int EXHAUSTIVE_LIMIT = 5000;
+
+static double timeSolver(AbstractSolver &solver, const NodesDistPair &nodes, int &score)
+{
+    Stopwatch stopwatch;
+    Solution solution = solver.solve(nodes, 0, nodes.nodes.size() / 2);
+    double elapsed = stopwatch.seconds();
+    score = evaluateSolution(nodes.nodes, solution);
+    return elapsed;
+}
+
+static void compare(const std::string &label, AbstractSolver &fast, AbstractSolver &reference, const NodesDistPair &nodes, bool run_reference)
+{
+    int fast_score = 0;
+    double fast_time = timeSolver(fast, nodes, fast_score);
+    std::cout << "  " << label << "\tincremental " << fast_time << " s (score " << fast_score << ")";
+    if (run_reference)
+    {
+        int reference_score = 0;
+        double reference_time = timeSolver(reference, nodes, reference_score);
+        std::cout << "\texhaustive " << reference_time << " s (score " << reference_score << ")"
+                  << "\tspeedup " << reference_time / fast_time << "x";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    bool force_exhaustive = argc > 1 && std::string(argv[1]) == "--exhaustive";
+    if (force_exhaustive)
+    {
+        --argc;
+        ++argv;
+    }
+
+    for (int size : benchmarkSizes(argc, argv, {200, 2000, 20000}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        bool run_reference = force_exhaustive || size <= EXHAUSTIVE_LIMIT;
+        std::cout << "n = " << size << std::endl;
+
+        GreedyCycleSolver incremental_cycle(true);
+        GreedyCycleSolver exhaustive_cycle(false);
+        compare("greedy cycle", incremental_cycle, exhaustive_cycle, nodes, run_reference);
+
+        GreedyTwoRegretSolver incremental_regret(1.0, 1.0, true);
+        GreedyTwoRegretSolver exhaustive_regret(1.0, 1.0, false);
+        compare("two regret", incremental_regret, exhaustive_regret, nodes, run_reference);
+    }
+}
@@ -0,0 +1,108 @@
+#include "bench_common.hpp"
+#include "spatial_index.hpp"
+
+#include <iostream>
+#include <limits>
+
+// Quadratic reference scans are skipped above this size.
+constexpr static int SCAN_LIMIT = 20000;
+constexpr static int NUM_CANDIDATES = 10;
+
+static std::vector<std::vector<int>> scanCandidates(const Nodes &nodes)
+{
+    std::vector<std::vector<int>> candidates(nodes.size());
+    std::vector<std::pair<int, int>> ranking;
+    for (int i = 0; i < nodes.size(); ++i)
+    {
+        ranking.clear();
+        for (int j = 0; j < nodes.size(); ++j)
+        {
+            if (i != j)
+            {
+                ranking.push_back({nodes[i].distanceTo(nodes[j]) + nodes[j].getWeight(), j});
+            }
+        }
+        std::sort(ranking.begin(), ranking.end());
+        for (int j = 0; j < NUM_CANDIDATES; ++j)
+        {
+            candidates[i].push_back(ranking[j].second);
+        }
+    }
+    return candidates;
+}
+
+static Solution scanNearestNeighbour(const Nodes &nodes, int visit_count)
+{
+    std::vector<bool> visited(nodes.size(), false);
+    Solution solution = {0};
+    visited[0] = true;
+    while (solution.size() < visit_count)
+    {
+        int current = solution.back();
+        int min_score = std::numeric_limits<int>::max();
+        int min_idx = -1;
+        for (int j = 0; j < nodes.size(); ++j)
+        {
+            int score = nodes[current].distanceTo(nodes[j]) + nodes[j].getWeight();
+            if (!visited[j] && score < min_score)
+            {
+                min_score = score;
+                min_idx = j;
+            }
+        }
+        solution.push_back(min_idx);
+        visited[min_idx] = true;
+    }
+    return solution;
+}
+
+static Solution indexNearestNeighbour(const Nodes &nodes, int visit_count)
+{
+    SpatialIndex index(nodes);
+    Solution solution = {0};
+    index.deactivate(0);
+    while (solution.size() < visit_count)
+    {
+        int next = index.nearestActive(solution.back());
+        solution.push_back(next);
+        index.deactivate(next);
+    }
+    return solution;
+}
+
+int main(int argc, char **argv)
+{
+    for (int size : benchmarkSizes(argc, argv, {2000, 20000, 100000}))
+    {
+        Nodes nodes = generateInstance(size);
+        bool run_scan = size <= SCAN_LIMIT;
+        std::cout << "n = " << size << std::endl;
+
+        Stopwatch index_candidates_time;
+        SpatialIndex index(nodes);
+        std::vector<std::vector<int>> candidates(size);
+        for (int i = 0; i < size; ++i)
+        {
+            candidates[i] = index.kNearest(i, NUM_CANDIDATES);
+        }
+        std::cout << "  candidates\tindex " << index_candidates_time.seconds() << " s";
+        if (run_scan)
+        {
+            Stopwatch scan_time;
+            bool same = scanCandidates(nodes) == candidates;
+            std::cout << "\tscan " << scan_time.seconds() << " s\tidentical " << same;
+        }
+        std::cout << std::endl;
+
+        Stopwatch index_tour_time;
+        Solution tour = indexNearestNeighbour(nodes, size / 2);
+        std::cout << "  nearest neighbour\tindex " << index_tour_time.seconds() << " s";
+        if (run_scan)
+        {
+            Stopwatch scan_time;
+            bool same = scanNearestNeighbour(nodes, size / 2) == tour;
+            std::cout << "\tscan " << scan_time.seconds() << " s\tidentical " << same;
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,46 @@
+#include "bench_common.hpp"
+#include "improvers.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+// Steepest or-opt descent from a random half-size tour with the full scan split over
+// 1..N threads, N being the hardware threads but at least 4. Every run has to end in
+// the same tour as the single-threaded one. Times are the best of a few runs; with
+// fewer hardware threads than pool threads they only show the pool's overhead.
+int main(int argc, char **argv)
+{
+    const int runs = 3;
+    const int max_threads = std::max(4u, std::thread::hardware_concurrency());
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    for (int size : benchmarkSizes(argc, argv, {500, 1000, 2000}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        Solution start = generateRandomSolution(size, size / 2);
+        std::cout << "n = " << size << std::endl;
+
+        Solution reference;
+        double single_time = 0.0;
+        for (int num_threads = 1; num_threads <= max_threads; ++num_threads)
+        {
+            SteepestImprover improver(NeighborhoodType::OR_OPT, num_threads);
+            Solution solution;
+            double seconds = 0.0;
+            for (int run = 0; run < runs; ++run)
+            {
+                solution = start;
+                Stopwatch time;
+                improver.improve(solution, nodes);
+                seconds = run == 0 ? time.seconds() : std::min(seconds, time.seconds());
+            }
+            if (num_threads == 1)
+            {
+                reference = solution;
+                single_time = seconds;
+            }
+            std::cout << "  " << num_threads << " threads\t" << seconds << " s\tspeedup " << single_time / seconds
+                      << (solution == reference ? "\tsame tour" : "\tDIFFERENT TOUR") << std::endl;
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#include "bench_common.hpp"
+#include "improvers.hpp"
+
+#include <climits>
+#include <iostream>
+
+// Don't-look bits descent from a random half-size tour with the tour kept in an array
+// and in a two-level list. Both visit the same moves up to tie-breaking, so the gap in
+// time is the cost of the path reversals.
+int main(int argc, char **argv)
+{
+    const int num_candidates = 10;
+    for (int size : benchmarkSizes(argc, argv, {2000, 5000, 10000, 20000, 30000}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        Solution start = generateRandomSolution(size, size / 2);
+        getCandidateLists(nodes.nodes, num_candidates);
+        std::cout << "n = " << size << std::endl;
+
+        for (int two_level_size : {INT_MAX, 0})
+        {
+            Solution solution = start;
+            DontLookBitsImprover improver(NeighborhoodType::EDGE, num_candidates, two_level_size);
+            Stopwatch time;
+            improver.improve(solution, nodes);
+            std::cout << (two_level_size == 0 ? "  two-level list\t" : "  array\t\t") << time.seconds()
+                      << " s\tcost " << evaluateSolution(nodes.nodes, solution) << std::endl;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#include "bench_common.hpp"
+#include "improvers.hpp"
+#include "tour_state.hpp"
+
+#include <iostream>
+#include <limits>
+
+static const char IMPROVERS[] = {'p', 'c', 'v'};
+static const int NUM_CANDIDATES = 10;
+static const int NUM_STARTS = 5;
+
+// Perturbation of the iterated local search: random edge swaps and node replacements.
+static void perturb(Solution &solution, int num_nodes, std::mt19937 &rng)
+{
+    TourState state(solution, num_nodes);
+    for (int i = 0; i < 10; ++i)
+    {
+        if (rng() % 2 == 0)
+        {
+            const std::vector<int> &outside = state.outsideNodes();
+            state.replaceNode(rng() % state.size(), outside[rng() % outside.size()]);
+        }
+        else
+        {
+            state.swapEdges(rng() % state.size(), rng() % state.size());
+        }
+    }
+    solution = state.tour();
+}
+
+// Seconds an iterated local search with the given improver needs to reach the target.
+static double timeToTarget(char type, const NodesDistPair &nodes, Solution solution, int target, double time_limit)
+{
+    std::mt19937 rng(7);
+    Rng improver_rng;
+    auto improver = createImprover(type, NeighborhoodType::EDGE, NUM_CANDIDATES, improver_rng);
+    Stopwatch stopwatch;
+    improver->improve(solution, nodes);
+    int score = evaluateSolution(nodes.nodes, solution);
+    while (score > target)
+    {
+        if (stopwatch.seconds() > time_limit)
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+        Solution candidate = solution;
+        perturb(candidate, nodes.nodes.size(), rng);
+        improver->improve(candidate, nodes);
+        int candidate_score = evaluateSolution(nodes.nodes, candidate);
+        if (candidate_score < score)
+        {
+            score = candidate_score;
+            solution = candidate;
+        }
+    }
+    return stopwatch.seconds();
+}
+
+int main(int argc, char **argv)
+{
+    for (int size : benchmarkSizes(argc, argv, {200, 500, 1000}))
+    {
+        NodesDistPair nodes(generateInstance(size));
+        getCandidateLists(nodes.nodes, NUM_CANDIDATES);
+        std::cout << "n = " << size << std::endl;
+
+        int best_descent = std::numeric_limits<int>::max();
+        Rng improver_rng;
+        for (char type : IMPROVERS)
+        {
+            long long total = 0;
+            Stopwatch stopwatch;
+            for (int seed = 0; seed < NUM_STARTS; ++seed)
+            {
+                Solution solution = generateRandomSolution(size, size / 2, seed);
+                createImprover(type, NeighborhoodType::EDGE, NUM_CANDIDATES, improver_rng)->improve(solution, nodes);
+                int score = evaluateSolution(nodes.nodes, solution);
+                total += score;
+                best_descent = std::min(best_descent, score);
+            }
+            std::cout << "  descent '" << type << "'\t" << stopwatch.seconds() / NUM_STARTS << " s\tmean cost "
+                      << total / NUM_STARTS << std::endl;
+        }
+
+        // target: 2% below the best single descent of any improver
+        int target = best_descent * 0.98;
+        for (char type : IMPROVERS)
+        {
+            double seconds = timeToTarget(type, nodes, generateRandomSolution(size, size / 2), target, 30.0);
+            std::cout << "  time to " << target << " '" << type << "'\t" << seconds << " s" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include "bench_common.hpp"
+#include "random.hpp"
+
+#include <iostream>
+
+// Reference sampler the Fenwick tree replaced: a new distribution over all weights
+// for every draw.
+static std::vector<int> discreteDistributionSample(std::vector<int> weights, int sample_size, Rng &rng)
+{
+    std::vector<int> samples;
+    for (int i = 0; i < sample_size; ++i)
+    {
+        std::discrete_distribution<int> dist(weights.begin(), weights.end());
+        int sample = dist(rng);
+        samples.push_back(sample);
+        weights[sample] = 0;
+    }
+    return samples;
+}
+
+// Disruption of a large neighborhood search iteration: removing 10-30% of a tour of
+// the given size with probability proportional to the cost of each node.
+int main(int argc, char **argv)
+{
+    for (int size : benchmarkSizes(argc, argv, {100, 1000, 5000}))
+    {
+        std::mt19937 generator(size);
+        std::uniform_int_distribution<int> cost(1, 6000);
+        std::vector<int> weights(size);
+        for (int &weight : weights)
+        {
+            weight = cost(generator);
+        }
+        std::cout << "n = " << size << '\n';
+
+        for (int percent : {10, 20, 30})
+        {
+            const int sample_size = size * percent / 100;
+            Rng rng(1);
+            long long checksum = 0;
+
+            int rounds = 0;
+            Stopwatch reference_time;
+            while (reference_time.seconds() < 0.3)
+            {
+                checksum += discreteDistributionSample(weights, sample_size, rng).back();
+                ++rounds;
+            }
+            double reference = reference_time.seconds() / rounds;
+
+            WeightedSampler sampler;
+            std::vector<int> samples;
+            rounds = 0;
+            Stopwatch fenwick_time;
+            while (fenwick_time.seconds() < 0.3)
+            {
+                sampler.assign(weights);
+                sampler.sampleWithoutReplacement(sample_size, rng, samples);
+                checksum += samples.back();
+                ++rounds;
+            }
+            double fenwick = fenwick_time.seconds() / rounds;
+            doNotOptimize(checksum);
+
+            std::cout << "  " << percent << "%\tdiscrete_distribution " << reference * 1e6 << " us\tfenwick "
+                      << fenwick * 1e6 << " us\tspeedup " << reference / fenwick << '\n';
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "node.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Immutable lists of the closest nodes (by distance plus weight) of every node.
+class CandidateLists
+{
+public:
+    CandidateLists(const Nodes &nodes, int num_candidates);
+    CandidateLists(int num_nodes, int num_candidates, std::vector<int> candidates);
+
+    std::span<const int> operator[](int node) const noexcept
+    {
+        return {m_candidates.data() + node * m_num_candidates, static_cast<std::size_t>(m_num_candidates)};
+    }
+
+    int numNodes() const noexcept { return m_num_nodes; }
+    int numCandidates() const noexcept { return m_num_candidates; }
+
+private:
+    int m_num_nodes;
+    int m_num_candidates;
+    std::vector<int> m_candidates;
+};
+
+// Identifies an instance by its coordinates and weights.
+std::uint64_t fingerprintNodes(const Nodes &nodes);
+
+// Returns the lists for the instance, building them on first use. The lists are
+// cached per (instance, num_candidates) and shared by all callers and threads;
+// only the most recently built ones are kept, older ones are rebuilt on demand.
+std::shared_ptr<const CandidateLists> getCandidateLists(const Nodes &nodes, int num_candidates);
+
+// Same as getCandidateLists, but persists the lists next to the instance file
+// and reuses them in later runs as long as the instance did not change. If the
+// file cannot be written, a warning is printed and the lists are still returned.
+std::shared_ptr<const CandidateLists> loadCandidateLists(
+    const Nodes &nodes,
+    int num_candidates,
+    const std::string &instance_filename);
+
+std::string candidateListsFilename(const std::string &instance_filename, int num_candidates);
@@ -18,3 +18,46 @@ int getReplaceNodeDelta(
     const NodesDistPair &nodes,
     const Solution &solution,
     int sol_idx, int node_idx);
+
+int getOrOptDelta(
+    const NodesDistPair &nodes,
+    const Solution &solution,
+    int first_idx,
+    int length,
+    int target_idx,
+    bool reversed);
+
+// Smallest delta of a batch of moves and the position in the batch where it first
+// occurs. An empty batch gives INT_MAX at position -1.
+struct BatchMin
+{
+    int delta;
+    int index;
+};
+
+// Edge swaps (first_idx, second_idx[k]) for k < count, with the same deltas as
+// getEdgesSwapDelta.
+BatchMin minEdgesSwapDelta(
+    const NodesDistPair &nodes,
+    const Solution &solution,
+    int first_idx,
+    const int *second_idx,
+    int count);
+
+// Replacements of the node at sol_idx by node_idx[k] for k < count, with the same
+// deltas as getReplaceNodeDelta.
+BatchMin minReplaceNodeDelta(
+    const NodesDistPair &nodes,
+    const Solution &solution,
+    int sol_idx,
+    const int *node_idx,
+    int count);
+
+// Whether the batched kernels run on AVX2 gathers on this machine; otherwise they
+// fall back to scalar loops.
+bool batchKernelsUseAvx2();
+
+// Whether the AVX2 edge swap kernel can address a distance matrix of num_rows rows of
+// stride ints: it gathers from the whole matrix with 32-bit offsets, so larger
+// matrices, from about 46k nodes on, are scanned by the scalar loop.
+bool edgeSwapGatherFits(std::size_t num_rows, std::size_t stride);
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <span>
+#include <vector>
+
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator
+{
+    typedef T value_type;
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+    template <typename U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    T *allocate(std::size_t count)
+    {
+        return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T *ptr, std::size_t) noexcept
+    {
+        ::operator delete(ptr, std::align_val_t{Alignment});
+    }
+
+    bool operator==(const AlignedAllocator &) const noexcept { return true; }
+    bool operator!=(const AlignedAllocator &) const noexcept { return false; }
+};
+
+// Square matrix stored row-major in a single cache-aligned block.
+// Every row starts on a cache line boundary, rows are padded with zeros.
+class DistanceMatrix
+{
+public:
+    constexpr static std::size_t ALIGNMENT = 64;
+
+    DistanceMatrix() = default;
+    explicit DistanceMatrix(std::size_t size);
+    DistanceMatrix(std::initializer_list<std::initializer_list<int>> rows);
+
+    std::span<int> operator[](std::size_t row) noexcept
+    {
+        return {m_data.data() + row * m_stride, m_size};
+    }
+
+    std::span<const int> operator[](std::size_t row) const noexcept
+    {
+        return {m_data.data() + row * m_stride, m_size};
+    }
+
+    std::size_t size() const noexcept { return m_size; }
+    std::size_t stride() const noexcept { return m_stride; }
+    const int *data() const noexcept { return m_data.data(); }
+
+private:
+    std::size_t m_size = 0;
+    std::size_t m_stride = 0;
+    std::vector<int, AlignedAllocator<int, ALIGNMENT>> m_data;
+};
@@ -3,49 +3,95 @@
 #include "solution.hpp"
 #include "delta.hpp"
 #include "random.hpp"
+#include "candidates.hpp"
+#include "tour_state.hpp"
+#include "thread_pool.hpp"
+#include <cstdint>
 #include <vector>
 #include <memory>
 
+// OR_OPT combines edge swaps with segment relocations.
 enum class NeighborhoodType
 {
     NODE,
     EDGE,
-    BOTH
+    BOTH,
+    OR_OPT
 };
 
+constexpr bool includesNodeSwaps(NeighborhoodType type)
+{
+    return type == NeighborhoodType::NODE || type == NeighborhoodType::BOTH;
+}
+
+constexpr bool includesEdgeSwaps(NeighborhoodType type)
+{
+    return type != NeighborhoodType::NODE;
+}
+
+constexpr bool includesOrOpt(NeighborhoodType type)
+{
+    return type == NeighborhoodType::OR_OPT;
+}
+
+// FORBIDDEN marks the absence of a move and is never encoded.
 enum class OperationType
 {
     NODE_SWAP,
     EDGE_SWAP,
     NODE_REPLACE,
+    OR_OPT,
     FORBIDDEN
 };
 
+// Moves are packed into 64 bits: 2 bits of type and 31 bits for each index.
+// Or-opt moves keep the segment length and direction in the low 3 bits of the
+// second index, which limits their target position to 2^28 - 1.
+typedef std::uint64_t Operation;
+
+// The same layout in 32 bits, with 15 bits for each index, which halves the move
+// vectors of the instances that fit (see fitsCompactOperation).
+typedef std::uint32_t CompactOperation;
+
+constexpr int MAX_SEGMENT_LENGTH = 3;
+
 struct OpData
 {
     OperationType m_type;
     int m_first_idx;
     int m_second_idx;
+    // Or-opt only: the segment of m_length nodes starting at m_first_idx is moved
+    // between m_second_idx and its successor, reversed if m_reversed is set.
+    int m_length = 1;
+    bool m_reversed = false;
 
     OpData(OperationType type, int i, int j)
         : m_type(type), m_first_idx(i), m_second_idx(j) {}
 
-    OpData(int operation);
-    int toInt() const;
+    OpData(OperationType type, int i, int j, int length, bool reversed)
+        : m_type(type), m_first_idx(i), m_second_idx(j), m_length(length), m_reversed(reversed) {}
+
+    OpData(Operation operation);
+    Operation toInt() const;
+    static OpData fromCompact(CompactOperation operation);
+    CompactOperation toCompact() const;
     bool isInvalid() const;
-    virtual bool isApplicable(const Solution &solution) const;
+    bool isApplicable(const Solution &solution) const;
+    bool isApplicable(const TourState &state) const;
     int evaluate(const Solution &solution, const NodesDistPair &nodes) const;
-    Solution apply(Solution &solution) const;
+    void apply(Solution &solution) const;
+    void apply(TourState &state) const;
     void print() const;
 };
 
-std::vector<int> getNeighborhoodOperations(
+std::vector<Operation> getNeighborhoodOperations(
     const Solution &solution,
     int num_nodes,
     NeighborhoodType type);
 
-int evaluateOperation(int operation, const Solution &solution, const NodesDistPair &nodes);
-Solution applyOperation(int operation, Solution &solution);
+// Whether every move of the neighborhood of a tour of tour_size nodes out of num_nodes
+// can be packed into a CompactOperation.
+bool fitsCompactOperation(int tour_size, int num_nodes, NeighborhoodType type);
 
 class AbstractImprover
 {
@@ -60,31 +106,42 @@ public:
 
 protected:
     NeighborhoodType m_ntype;
-
-    virtual std::vector<int> generateOperationsVector(const Solution &solution, const NodesDistPair &nodes);
-    virtual void updateOperationsVector(std::vector<int> &operations, const Solution &solution, const OpData &op) const;
 };
 
 class GreedyImprover : public AbstractImprover
 {
 public:
-    GreedyImprover(NeighborhoodType ntype = NeighborhoodType::BOTH)
-        : AbstractImprover(ntype) {}
+    GreedyImprover(NeighborhoodType ntype, Rng &rng)
+        : AbstractImprover(ntype), m_rng(rng) {}
     Solution improve(Solution &solution, const NodesDistPair &nodes) override;
 
 private:
-    std::default_random_engine &m_rng = getRandomEngine();
+    template <typename Word>
+    void descend(TourState &state, const NodesDistPair &nodes);
+    template <NeighborhoodType NType, typename Word>
+    void descend(TourState &state, std::vector<Word> &operations, const NodesDistPair &nodes);
+
+    Rng &m_rng;
 };
 
+// NODE, EDGE and BOTH are searched through MoveCache on one thread. OR_OPT, or any
+// neighborhood when full_scan is set, is searched by scanning every move after each
+// step, split over a thread pool when there is more than one thread.
 class SteepestImprover : public AbstractImprover
 {
 public:
-    SteepestImprover(NeighborhoodType ntype)
-        : AbstractImprover(ntype) {}
+    SteepestImprover(NeighborhoodType ntype, int num_threads = 1, bool full_scan = false)
+        : AbstractImprover(ntype),
+          m_pool(num_threads > 1 ? std::make_unique<ThreadPool>(num_threads) : nullptr),
+          m_full_scan(full_scan || includesOrOpt(ntype)) {}
     Solution improve(Solution &solution, const NodesDistPair &nodes) override;
 
-protected:
-    virtual void updateOperationsVectorPostApply(std::vector<int> &operations, const Solution &solution, const OpData &op) const {};
+private:
+    // rows are handed out in smaller chunks than one per thread to even out the load
+    constexpr static int CHUNKS_PER_THREAD = 8;
+
+    std::unique_ptr<ThreadPool> m_pool;
+    bool m_full_scan;
 };
 
 class SteepestCandidateImprover : public SteepestImprover
@@ -95,15 +152,24 @@ public:
     {
     }
 
+    Solution improve(Solution &solution, const NodesDistPair &nodes) override;
+
 protected:
-    std::vector<int> generateOperationsVector(const Solution &solution, const NodesDistPair &nodes) override;
-    void updateOperationsVector(std::vector<int> &operations, const Solution &solution, const OpData &op) const override;
-    void updateOperationsVectorPostApply(std::vector<int> &operations, const Solution &solution, const OpData &op) const override;
+    template <typename Word>
+    void descend(TourState &state, const NodesDistPair &nodes);
+    // Or-opt moves of the candidate lists, with the rank of each in the order of the scan.
+    template <typename Word>
+    void fillOperationsVector(std::vector<Word> &operations, std::vector<int> &ranks, const TourState &state) const;
 
-    std::vector<std::vector<int>> m_closest_nodes;
+    // two edge swaps or replacements and then the or-opt moves of each candidate
+    constexpr static int MOVES_PER_CANDIDATE = 4 + 4 * (MAX_SEGMENT_LENGTH - 1);
+
+    std::shared_ptr<const CandidateLists> m_closest_nodes;
     int m_num_candidates;
 };
 
+// Steepest descent driven by the priority queue of improving moves in MoveCache, which
+// SteepestImprover uses for the same neighborhoods.
 class SteepestSimplePrioritizingImprover : public SteepestImprover
 {
 public:
@@ -115,47 +181,133 @@ public:
             throw std::runtime_error("SteepestSimplePrioritizingImprover can only be used with edge neighborhood");
         }
     }
+};
+
+// 2-opt and node replacement over the candidate lists, driven by a queue of nodes
+// whose surroundings changed (don't-look bits). The best move around a queued node is
+// applied right away. Moves whose partial gain cannot be positive are not evaluated,
+// so one visit of a node costs O(k). Tours of at least two_level_size nodes are kept
+// in a TwoLevelList, smaller ones in a TourState.
+class DontLookBitsImprover : public AbstractImprover
+{
+public:
+    DontLookBitsImprover(NeighborhoodType ntype, int num_candidates, int two_level_size = 10000)
+        : AbstractImprover(ntype), m_num_candidates(num_candidates), m_two_level_size(two_level_size)
+    {
+        if (ntype != NeighborhoodType::EDGE)
+        {
+            throw std::runtime_error("DontLookBitsImprover can only be used with edge neighborhood");
+        }
+    }
 
     Solution improve(Solution &solution, const NodesDistPair &nodes) override;
+
+protected:
+    // EDGE_SWAP reverses the path from first to second, NODE_REPLACE puts second in place of first.
+    struct Move
+    {
+        OperationType type;
+        int first;
+        int second;
+    };
+
+    template <typename Tour>
+    Move findImprovingMove(const Tour &tour, const NodesDistPair &nodes, int node) const;
+    template <typename Tour>
+    void descend(Tour &tour, const Solution &solution, const NodesDistPair &nodes) const;
+
+    std::shared_ptr<const CandidateLists> m_closest_nodes;
+    int m_num_candidates;
+    int m_two_level_size;
+};
+
+// Lin-Kernighan style variable-depth search. From an active node it chains up to
+// max_depth candidate 2-opt and node replacement moves, each starting at the far end
+// of the edge closed by the previous one, as long as the partial gain stays positive.
+// Edges added by the chain are never removed again. The most profitable prefix of
+// the chain is kept and the rest is undone; if no prefix gains, the chain is retried
+// with the next best first move, up to breadth times.
+class VariableDepthImprover : public AbstractImprover
+{
+public:
+    VariableDepthImprover(NeighborhoodType ntype, int num_candidates, int max_depth = 10, int breadth = 5)
+        : AbstractImprover(ntype), m_num_candidates(num_candidates), m_max_depth(max_depth), m_breadth(breadth)
+    {
+        if (ntype != NeighborhoodType::EDGE)
+        {
+            throw std::runtime_error("VariableDepthImprover can only be used with edge neighborhood");
+        }
+    }
+
+    Solution improve(Solution &solution, const NodesDistPair &nodes) override;
+
+protected:
+    typedef std::vector<std::pair<int, int>> Edges;
+
+    struct ChainMove
+    {
+        OpData op;
+        int delta;
+        // removed minus added length, leaving out the edge that closes the tour
+        int gain;
+    };
+
+    // Moves around the node that keep the partial gain positive and do not remove added edges.
+    void collectChainMoves(
+        const TourState &state,
+        const NodesDistPair &nodes,
+        int node,
+        int gain,
+        const Edges &added_edges,
+        std::vector<ChainMove> &moves) const;
+
+    std::shared_ptr<const CandidateLists> m_closest_nodes;
+    int m_num_candidates;
+    int m_max_depth;
+    int m_breadth;
 };
 
 NeighborhoodType getNeighborhoodType(const std::string &ntype);
 
+// Inner improvers are created with the same engine, so they continue its stream.
 class CompositeImprover : public AbstractImprover
 {
 public:
-    CompositeImprover(NeighborhoodType ntype, char improver_type, int param)
-        : AbstractImprover(ntype), m_improver_type(improver_type), m_param(param) {}
+    CompositeImprover(NeighborhoodType ntype, char improver_type, int param, Rng &rng)
+        : AbstractImprover(ntype), m_improver_type(improver_type), m_param(param), m_rng(rng) {}
 
 protected:
     char m_improver_type;
     int m_param;
-    std::default_random_engine &m_rng = getRandomEngine();
+    Rng &m_rng;
 };
 
+// Restarts are independent: each one draws from its own stream, split in order off an
+// engine seeded with seed, so spreading them over a thread pool gives the same result.
 class MultipleStartImprover : public CompositeImprover
 {
 public:
-    MultipleStartImprover(NeighborhoodType ntype, char improver_type, int param, int seed, int repeats)
-        : CompositeImprover(ntype, improver_type, param), m_seed(seed), m_repeats(repeats) {}
+    MultipleStartImprover(NeighborhoodType ntype, char improver_type, int param, Rng &rng, int seed, int repeats, int num_threads = 1)
+        : CompositeImprover(ntype, improver_type, param, rng), m_seed(seed), m_repeats(repeats),
+          m_pool(num_threads > 1 ? std::make_unique<ThreadPool>(num_threads) : nullptr) {}
 
     Solution improve(Solution &solution, const NodesDistPair &nodes) override;
 
 protected:
-    Solution randomizeSolution(const NodesDistPair &nodes, int seed_idx, int target_size) const;
+    Solution randomizeSolution(const NodesDistPair &nodes, Rng &rng, int target_size) const;
 
-    int m_repeats;
     int m_seed;
+    int m_repeats;
 
 private:
-    const int SEED_SPREAD = 1000;
+    std::unique_ptr<ThreadPool> m_pool;
 };
 
 class IteratedImprover : public CompositeImprover
 {
 public:
-    IteratedImprover(NeighborhoodType ntype, char improver_type, int param, double time_limit, int perturb_size)
-        : CompositeImprover(ntype, improver_type, param), m_time_limit(time_limit), m_perturb_size(perturb_size) {}
+    IteratedImprover(NeighborhoodType ntype, char improver_type, int param, Rng &rng, double time_limit, int perturb_size)
+        : CompositeImprover(ntype, improver_type, param, rng), m_time_limit(time_limit), m_perturb_size(perturb_size) {}
 
     Solution improve(Solution &solution, const NodesDistPair &nodes) override;
 
@@ -172,8 +324,8 @@ protected:
 class LargeNeighborhoodImprover : public CompositeImprover
 {
 public:
-    LargeNeighborhoodImprover(NeighborhoodType ntype, char improver_type, int param, double time_limit, int disrupt_size)
-        : CompositeImprover(ntype, improver_type, param), m_time_limit(time_limit), m_disrupt_size(disrupt_size) {}
+    LargeNeighborhoodImprover(NeighborhoodType ntype, char improver_type, int param, Rng &rng, double time_limit, int disrupt_size)
+        : CompositeImprover(ntype, improver_type, param, rng), m_time_limit(time_limit), m_disrupt_size(disrupt_size) {}
 
     Solution improve(Solution &solution, const NodesDistPair &nodes) override;
 
@@ -187,14 +339,24 @@ protected:
     double m_time_limit;
     int m_disrupt_size;
     int m_iterations = 0;
-    std::default_random_engine &m_rng = getRandomEngine();
+    // kept across iterations to reuse their storage
+    WeightedSampler m_sampler;
+    std::vector<int> m_to_remove;
 };
 
+// With more than one island, every island evolves its own population on its own
+// thread and random stream, and every migration_interval iterations sends its best
+// solution to the next island in a ring. Islands stop at the first check of the time
+// limit after their current local search, and the best solution of all islands is
+// returned once every island has stopped. An exception thrown on an island is rethrown
+// by improve at that point.
 class GeneticLocalSearchImprover : public CompositeImprover
 {
 public:
-    GeneticLocalSearchImprover(NeighborhoodType ntype, char improver_type, int param, double time_limit, int elite_size)
-        : CompositeImprover(ntype, improver_type, param), m_time_limit(time_limit), m_elite_size(elite_size) {}
+    GeneticLocalSearchImprover(NeighborhoodType ntype, char improver_type, int param, Rng &rng, double time_limit, int elite_size,
+                               int num_islands = 1, int migration_interval = DEFAULT_MIGRATION_INTERVAL)
+        : CompositeImprover(ntype, improver_type, param, rng), m_time_limit(time_limit), m_elite_size(elite_size),
+          m_num_islands(num_islands), m_migration_interval(migration_interval) {}
 
     Solution improve(Solution &solution, const NodesDistPair &nodes) override;
 
@@ -214,29 +376,49 @@ protected:
 
     typedef std::vector<EvaluatedSolution> Population;
 
-    virtual Solution recombine(Solution &s1, Solution &s2, const Nodes &nodes) const noexcept;
-    virtual Population initializePopulation(const NodesDistPair &nodes) noexcept;
+    constexpr static int DEFAULT_MIGRATION_INTERVAL = 20;
+    constexpr static int MAILBOX_CAPACITY = 4;
+
+    // Random draws go to the engine of the population, which is the island's own.
+    virtual Solution recombine(Solution &s1, Solution &s2, const NodesDistPair &nodes, Rng &rng) const;
+    virtual Population initializePopulation(const NodesDistPair &nodes, Rng &rng);
+    // Produces one child and adds it to the population if it qualifies.
+    void evolve(Population &population, const NodesDistPair &nodes, Rng &rng);
+    // Replaces the worst solution if the new one is better and no solution of the same
+    // cost is in the population yet.
+    static bool tryInsert(Population &population, const EvaluatedSolution &candidate);
+    Solution improveIslands(const NodesDistPair &nodes, int initial_cost);
 
     double m_time_limit;
     int m_elite_size;
+    int m_num_islands;
+    int m_migration_interval;
     int m_iterations = 0;
-    std::default_random_engine &m_rng = getRandomEngine();
 };
 
 class AlternativeGeneticLocalSearchImprover : public GeneticLocalSearchImprover
 {
 public:
-    AlternativeGeneticLocalSearchImprover(NeighborhoodType ntype, char improver_type, int param, double time_limit, int elite_size)
-        : GeneticLocalSearchImprover(ntype, improver_type, param, time_limit, elite_size) {}
+    AlternativeGeneticLocalSearchImprover(NeighborhoodType ntype, char improver_type, int param, Rng &rng, double time_limit, int elite_size,
+                                          int num_islands = 1, int migration_interval = DEFAULT_MIGRATION_INTERVAL)
+        : GeneticLocalSearchImprover(ntype, improver_type, param, rng, time_limit, elite_size, num_islands, migration_interval) {}
 
-    Solution recombine(Solution &s1, Solution &s2, const Nodes &nodes) const noexcept override;
+    Solution recombine(Solution &s1, Solution &s2, const NodesDistPair &nodes, Rng &rng) const override;
 };
 
+// num_threads is the size of the thread pool of s and m, and the number of islands
+// of e and a. The other improvers run on the calling thread.
 std::unique_ptr<AbstractImprover>
 createImprover(
     char name,
     NeighborhoodType ntype,
     int param,
+    Rng &rng,
     char subname = 'p',
     double subparam_1 = 10.0,
-    int subparam_2 = 10);
+    int subparam_2 = 10,
+    int num_threads = 1);
+
+// Whether more than one thread changes anything for the improver: s only spreads its
+// full scan, which it uses for OR_OPT.
+bool improverUsesThreads(char name, NeighborhoodType ntype);
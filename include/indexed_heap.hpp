@@ -0,0 +1,386 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Binary heap over integer keys in [0, capacity) that supports changing
+// and removing the priority of any key in O(log n). Keys with equal
+// priority are ordered by ascending key, which keeps tie-breaking stable.
+template <typename Priority, typename Compare = std::less<Priority>>
+class IndexedHeap
+{
+public:
+    explicit IndexedHeap(int capacity = 0)
+        : m_priorities(capacity), m_heap_position(capacity, NOT_IN_HEAP) {}
+
+    void reserve(int size) { m_heap.reserve(size); }
+    bool empty() const noexcept { return m_heap.empty(); }
+    int size() const noexcept { return m_heap.size(); }
+    int top() const { return m_heap.front(); }
+    const Priority &topPriority() const { return m_priorities[m_heap.front()]; }
+    const Priority &priority(int key) const { return m_priorities[key]; }
+
+    bool contains(int key) const noexcept
+    {
+        return m_heap_position[key] != NOT_IN_HEAP;
+    }
+
+    // Inserts the key or changes its priority if it is already present.
+    void update(int key, const Priority &priority)
+    {
+        if (!contains(key))
+        {
+            m_priorities[key] = priority;
+            m_heap_position[key] = m_heap.size();
+            m_heap.push_back(key);
+            siftUp(m_heap.size() - 1);
+            return;
+        }
+        m_priorities[key] = priority;
+        int position = m_heap_position[key];
+        siftUp(position);
+        siftDown(m_heap_position[key]);
+    }
+
+    void erase(int key)
+    {
+        if (!contains(key))
+        {
+            return;
+        }
+        int position = m_heap_position[key];
+        int last = m_heap.back();
+        m_heap_position[key] = NOT_IN_HEAP;
+        m_heap.pop_back();
+        if (last == key)
+        {
+            return;
+        }
+        m_heap[position] = last;
+        m_heap_position[last] = position;
+        siftUp(position);
+        siftDown(m_heap_position[last]);
+    }
+
+    void pop()
+    {
+        erase(top());
+    }
+
+    void clear()
+    {
+        for (int key : m_heap)
+        {
+            m_heap_position[key] = NOT_IN_HEAP;
+        }
+        m_heap.clear();
+    }
+
+private:
+    constexpr static int NOT_IN_HEAP = -1;
+
+    bool before(int first, int second) const
+    {
+        if (m_compare(m_priorities[first], m_priorities[second]))
+        {
+            return true;
+        }
+        if (m_compare(m_priorities[second], m_priorities[first]))
+        {
+            return false;
+        }
+        return first < second;
+    }
+
+    void place(int position, int key)
+    {
+        m_heap[position] = key;
+        m_heap_position[key] = position;
+    }
+
+    void siftUp(int position)
+    {
+        int key = m_heap[position];
+        while (position > 0)
+        {
+            int parent = (position - 1) / 2;
+            if (!before(key, m_heap[parent]))
+            {
+                break;
+            }
+            place(position, m_heap[parent]);
+            position = parent;
+        }
+        place(position, key);
+    }
+
+    void siftDown(int position)
+    {
+        int key = m_heap[position];
+        int size = m_heap.size();
+        while (true)
+        {
+            int child = 2 * position + 1;
+            if (child >= size)
+            {
+                break;
+            }
+            if (child + 1 < size && before(m_heap[child + 1], m_heap[child]))
+            {
+                ++child;
+            }
+            if (!before(m_heap[child], key))
+            {
+                break;
+            }
+            place(position, m_heap[child]);
+            position = child;
+        }
+        place(position, key);
+    }
+
+    std::vector<Priority> m_priorities;
+    std::vector<int> m_heap_position;
+    std::vector<int> m_heap;
+    Compare m_compare;
+};
+
+// IndexedHeap over sparse non-negative 64-bit keys. The heap position of each key is
+// kept in an open-addressing hash table instead of an array indexed by key, so memory
+// grows with the number of keys in the heap rather than with the key space. Nothing
+// is allocated while the heap stays within the size passed to reserve().
+template <typename Priority, typename Compare = std::less<Priority>>
+class SparseIndexedHeap
+{
+public:
+    typedef long long Key;
+
+    void reserve(int size)
+    {
+        m_heap.reserve(size);
+        if (2 * static_cast<std::size_t>(size) > m_slots.size())
+        {
+            rehash(size);
+        }
+    }
+
+    bool empty() const noexcept { return m_heap.empty(); }
+    int size() const noexcept { return m_heap.size(); }
+    Key top() const { return m_heap.front().key; }
+    const Priority &topPriority() const { return m_heap.front().priority; }
+
+    bool contains(Key key) const noexcept
+    {
+        return find(key) != NOT_FOUND;
+    }
+
+    // Inserts the key or changes its priority if it is already present.
+    void update(Key key, const Priority &priority)
+    {
+        std::size_t slot = find(key);
+        if (slot == NOT_FOUND)
+        {
+            if (2 * (m_heap.size() + 1) > m_slots.size())
+            {
+                rehash(2 * m_heap.size() + 8);
+            }
+            slot = home(key);
+            while (m_slots[slot].key != EMPTY)
+            {
+                slot = (slot + 1) & m_mask;
+            }
+            m_slots[slot] = {key, static_cast<int>(m_heap.size())};
+            m_heap.push_back({key, priority, static_cast<int>(slot)});
+            siftUp(m_heap.size() - 1);
+            return;
+        }
+        int position = m_slots[slot].position;
+        m_heap[position].priority = priority;
+        siftUp(position);
+        siftDown(m_slots[slot].position);
+    }
+
+    void erase(Key key)
+    {
+        std::size_t slot = find(key);
+        if (slot == NOT_FOUND)
+        {
+            return;
+        }
+        int position = m_slots[slot].position;
+        freeSlot(slot);
+        Entry last = m_heap.back();
+        m_heap.pop_back();
+        if (position == static_cast<int>(m_heap.size()))
+        {
+            return;
+        }
+        place(position, last);
+        siftUp(position);
+        siftDown(m_slots[last.slot].position);
+    }
+
+    void pop()
+    {
+        erase(top());
+    }
+
+    void clear()
+    {
+        for (const Entry &entry : m_heap)
+        {
+            m_slots[entry.slot].key = EMPTY;
+        }
+        m_heap.clear();
+    }
+
+private:
+    struct Entry
+    {
+        Key key;
+        Priority priority;
+        int slot;
+    };
+
+    struct Slot
+    {
+        Key key;
+        int position;
+    };
+
+    constexpr static Key EMPTY = -1;
+    constexpr static std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+    std::size_t home(Key key) const
+    {
+        return (static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> m_shift;
+    }
+
+    std::size_t find(Key key) const
+    {
+        if (m_slots.empty())
+        {
+            return NOT_FOUND;
+        }
+        for (std::size_t slot = home(key);; slot = (slot + 1) & m_mask)
+        {
+            if (m_slots[slot].key == key)
+            {
+                return slot;
+            }
+            if (m_slots[slot].key == EMPTY)
+            {
+                return NOT_FOUND;
+            }
+        }
+    }
+
+    // Linear probing without tombstones: the following keys of the probe run are moved
+    // back into the freed slot when it lies on their way from their home slot.
+    void freeSlot(std::size_t slot)
+    {
+        for (std::size_t next = (slot + 1) & m_mask; m_slots[next].key != EMPTY; next = (next + 1) & m_mask)
+        {
+            std::size_t next_home = home(m_slots[next].key);
+            bool in_place = slot < next ? slot < next_home && next_home <= next : slot < next_home || next_home <= next;
+            if (!in_place)
+            {
+                m_slots[slot] = m_slots[next];
+                m_heap[m_slots[slot].position].slot = slot;
+                slot = next;
+            }
+        }
+        m_slots[slot].key = EMPTY;
+    }
+
+    // at least twice as many slots as keys, rounded up to a power of two
+    void rehash(std::size_t size)
+    {
+        std::size_t capacity = 16;
+        m_shift = 60;
+        while (capacity < 2 * size)
+        {
+            capacity *= 2;
+            --m_shift;
+        }
+        m_mask = capacity - 1;
+        m_slots.assign(capacity, {EMPTY, 0});
+        for (std::size_t position = 0; position < m_heap.size(); ++position)
+        {
+            std::size_t slot = home(m_heap[position].key);
+            while (m_slots[slot].key != EMPTY)
+            {
+                slot = (slot + 1) & m_mask;
+            }
+            m_slots[slot] = {m_heap[position].key, static_cast<int>(position)};
+            m_heap[position].slot = slot;
+        }
+    }
+
+    bool before(const Entry &first, const Entry &second) const
+    {
+        if (m_compare(first.priority, second.priority))
+        {
+            return true;
+        }
+        if (m_compare(second.priority, first.priority))
+        {
+            return false;
+        }
+        return first.key < second.key;
+    }
+
+    void place(int position, const Entry &entry)
+    {
+        m_heap[position] = entry;
+        m_slots[entry.slot].position = position;
+    }
+
+    void siftUp(int position)
+    {
+        Entry entry = m_heap[position];
+        while (position > 0)
+        {
+            int parent = (position - 1) / 2;
+            if (!before(entry, m_heap[parent]))
+            {
+                break;
+            }
+            place(position, m_heap[parent]);
+            position = parent;
+        }
+        place(position, entry);
+    }
+
+    void siftDown(int position)
+    {
+        Entry entry = m_heap[position];
+        int size = m_heap.size();
+        while (true)
+        {
+            int child = 2 * position + 1;
+            if (child >= size)
+            {
+                break;
+            }
+            if (child + 1 < size && before(m_heap[child + 1], m_heap[child]))
+            {
+                ++child;
+            }
+            if (!before(m_heap[child], entry))
+            {
+                break;
+            }
+            place(position, m_heap[child]);
+            position = child;
+        }
+        place(position, entry);
+    }
+
+    std::vector<Entry> m_heap;
+    std::vector<Slot> m_slots;
+    std::size_t m_mask = 0;
+    unsigned int m_shift = 60;
+    Compare m_compare;
+};
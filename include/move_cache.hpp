@@ -0,0 +1,78 @@
+#pragma once
+
+#include "improvers.hpp"
+#include "indexed_heap.hpp"
+#include "tour_state.hpp"
+#include <vector>
+
+// Improving node swap, edge swap and node replacement moves of a tour, kept in an
+// indexed heap across the iterations of a steepest descent. Moves are keyed by the
+// nodes they touch instead of their positions, and an edge swap by the pair of tour
+// neighbours (x of a, y of c) it removes, so no delta depends on the orientation of
+// the tour and a reversal only changes the moves around its four endpoints. After a
+// move only the keys of nodes whose neighbours changed are evaluated again and updated
+// in place, so the heap never holds more than one entry per move. Only improving moves
+// are kept, in a SparseIndexedHeap, so memory follows their number instead of n^2.
+// Moves of equal delta are chosen in the order of the full scan of SteepestImprover.
+// Replacements are kept as a single key per tour node holding its best replacement,
+// found by scanning the outside nodes by increasing weight until no heavier one can
+// be cheaper.
+class MoveCache
+{
+public:
+    MoveCache(const TourState &state, const NodesDistPair &nodes, NeighborhoodType type);
+
+    // The best improving move of the current tour, or a FORBIDDEN one.
+    OpData bestMove(const TourState &state);
+    // Applies the move and evaluates the moves around it again.
+    void apply(TourState &state, const OpData &op);
+
+private:
+    typedef SparseIndexedHeap<int>::Key Key;
+
+    // an edge swap whose edges point in opposite directions in the current tour
+    struct Parked
+    {
+        Key key;
+        int delta;
+        unsigned first_stamp;
+        unsigned second_stamp;
+    };
+
+    // a valid move of the best delta
+    struct Tie
+    {
+        Key key;
+        int delta;
+        OpData op;
+    };
+
+    Key edgeSwapKey(int first, int second, int first_slot, int second_slot) const;
+    void update(Key key, int delta);
+    // The move of a key in the current tour, or a FORBIDDEN one if the key is stale or
+    // parked.
+    OpData moveOf(const TourState &state, Key key, int delta);
+    void evaluatePair(const TourState &state, int first, int second);
+    void evaluateReplacements(const TourState &state, int tour_node);
+    void offerReplacement(const TourState &state, int tour_node, int outside_node);
+    void eraseMovesOf(int node);
+    // orders nodes by weight and then by id
+    bool lighter(int first, int second) const;
+
+    constexpr static int NO_REPLACEMENT = -1;
+
+    const NodesDistPair &m_nodes;
+    const int m_num_nodes;
+    bool m_node_swaps;
+    bool m_edge_swaps;
+    // keys are laid out as edge swaps, node swaps and then replacements
+    Key m_swap_base;
+    Key m_replace_base;
+    SparseIndexedHeap<int> m_heap;
+    // bumped whenever the tour neighbours of a node change
+    std::vector<unsigned> m_stamp;
+    std::vector<Parked> m_parked;
+    std::vector<Tie> m_ties;
+    std::vector<int> m_best_replacement;
+    std::vector<int> m_outside_by_weight;
+};
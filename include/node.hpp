@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <string>
+#include "distance_matrix.hpp"
 
 class Node
 {
@@ -19,16 +20,19 @@ private:
 };
 
 typedef std::vector<Node> Nodes;
-typedef std::vector<std::vector<int>> DistanceMatrix;
 
 Nodes importNodesFromFile(const std::string &filename);
 
 DistanceMatrix calculateDistanceMatrix(const Nodes &nodes);
+std::vector<int> collectWeights(const Nodes &nodes);
 
+// weights repeats the node weights contiguously for the batched delta kernels
 struct NodesDistPair
 {
     Nodes nodes;
     DistanceMatrix dist;
+    std::vector<int> weights;
 
-    NodesDistPair(Nodes nodes) : nodes(std::move(nodes)), dist(calculateDistanceMatrix(this->nodes)) {}
+    NodesDistPair(Nodes nodes)
+        : nodes(std::move(nodes)), dist(calculateDistanceMatrix(this->nodes)), weights(collectWeights(this->nodes)) {}
 };
@@ -1,15 +1,99 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <random>
 #include <vector>
 
+// xoshiro256** generator. It meets UniformRandomBitGenerator, so the standard
+// distributions and algorithms accept it, and jump() moves it 2^128 draws ahead to
+// split off streams that never overlap.
+class Rng
+{
+public:
+    typedef std::uint64_t result_type;
+
+    explicit Rng(std::uint64_t seed = 0) { this->seed(seed); }
+
+    // The state is filled from the seed through splitmix64, so close seeds still
+    // start far apart.
+    void seed(std::uint64_t seed);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const std::uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+        const std::uint64_t shifted = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= shifted;
+        m_state[3] = rotl(m_state[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [0, bound) for bound > 0, by Lemire's multiply and reject,
+    // which avoids both the bias and the division of a modulo.
+    std::uint64_t below(std::uint64_t bound)
+    {
+        unsigned __int128 product = static_cast<unsigned __int128>((*this)()) * bound;
+        std::uint64_t low = product;
+        if (low < bound)
+        {
+            const std::uint64_t threshold = -bound % bound;
+            while (low < threshold)
+            {
+                product = static_cast<unsigned __int128>((*this)()) * bound;
+                low = product;
+            }
+        }
+        return product >> 64;
+    }
+
+    void jump();
+    // Returns a copy of the current stream and jumps this one past it.
+    Rng split();
+
+private:
+    static std::uint64_t rotl(std::uint64_t value, int shift)
+    {
+        return (value << shift) | (value >> (64 - shift));
+    }
+
+    std::uint64_t m_state[4];
+};
+
 std::vector<int> shuffledIndices(
     std::size_t size,
-    std::default_random_engine &rng);
+    Rng &rng);
+
+// Draws indices with probability proportional to non-negative integer weights. The
+// weights sit in a Fenwick tree, so a draw and a weight change both take O(log n),
+// and assign() reuses the storage of earlier calls.
+class WeightedSampler
+{
+public:
+    void assign(const std::vector<int> &weights);
+    long long total() const noexcept { return m_total; }
+    int weight(int index) const { return m_weights[index]; }
+    void set(int index, int weight);
+    int sample(Rng &rng) const;
+    // Replaces samples with sample_size distinct draws, each one made after the weights
+    // of the previous ones were set to zero.
+    void sampleWithoutReplacement(int sample_size, Rng &rng, std::vector<int> &samples);
 
-std::default_random_engine &getRandomEngine();
+private:
+    std::vector<int> m_weights;
+    // 1-based, entry i holds the sum of the weights in (i - lowbit(i), i]
+    std::vector<long long> m_tree;
+    long long m_total = 0;
+};
 
+// Sets the weights of the sampled indices to zero.
 std::vector<int> sampleWeightedWithoutReplacement(
     std::vector<int> &weights,
     int sample_size,
-    std::default_random_engine &rng);
\ No newline at end of file
+    Rng &rng);
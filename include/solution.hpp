@@ -10,6 +10,10 @@ int evaluateSolution(const Nodes &nodes, const Solution &solution);
 void exportSolutionToFile(const Solution &solution, const std::string &filename, int score, int time, const std::string &extra_info = "");
 Solution importSolutionFromFile(const std::string &filename);
 
-Solution swapNodes(Solution &solution, int first_idx, int second_idx);
-Solution replaceNode(Solution &solution, int sol_idx, int node_idx);
-Solution swapEdges(Solution &solution, int first_idx, int second_idx);
+// Moves are applied in place and return the same tour, nothing is copied or allocated.
+Solution &swapNodes(Solution &solution, int first_idx, int second_idx);
+Solution &replaceNode(Solution &solution, int sol_idx, int node_idx);
+Solution &swapEdges(Solution &solution, int first_idx, int second_idx);
+// Moves the segment [first_idx, first_idx + length) between target_idx and its successor.
+// The segment may not wrap around and target_idx may not be inside it or just before it.
+Solution &moveSegment(Solution &solution, int first_idx, int length, int target_idx, bool reversed);
@@ -10,7 +10,8 @@
 class AbstractSolver
 {
 public:
-    Solution solve(const Nodes &nodes, int start_idx, int visit_count);
+    // Distances are taken from the prebuilt matrix, solvers never recompute them.
+    Solution solve(const NodesDistPair &nodes, int start_idx, int visit_count);
     void setStartingSolution(const Solution &solution) { m_starting_solution = solution; }
     virtual ~AbstractSolver() = default;
 
@@ -18,20 +19,21 @@ protected:
     Solution m_starting_solution;
 
 private:
-    virtual void beforeSolve(const Nodes &nodes, int start_idx){};
-    virtual void afterSolve(const Nodes &nodes, int start_idx){};
-    virtual Solution _solve(const Nodes &nodes, int start_idx, int visit_count) = 0;
+    virtual void beforeSolve(const NodesDistPair &nodes, int start_idx){};
+    virtual void afterSolve(const NodesDistPair &nodes, int start_idx){};
+    virtual Solution _solve(const NodesDistPair &nodes, int start_idx, int visit_count) = 0;
 };
 
 class RandomSolver : public AbstractSolver
 {
 public:
-    RandomSolver() = default;
+    // The engine is reseeded from the start index before every solve.
+    explicit RandomSolver(Rng &rng) : m_rng(rng) {}
 
 private:
-    Solution _solve(const Nodes &nodes, int start_idx, int visit_count) override;
-    std::default_random_engine &m_rng = getRandomEngine();
-    void beforeSolve(const Nodes &nodes, int start_idx) override;
+    Solution _solve(const NodesDistPair &nodes, int start_idx, int visit_count) override;
+    Rng &m_rng;
+    void beforeSolve(const NodesDistPair &nodes, int start_idx) override;
 };
 
 class NearestNeighbourSolver : public AbstractSolver
@@ -40,29 +42,41 @@ public:
     NearestNeighbourSolver() = default;
 
 private:
-    void beforeSolve(const Nodes &nodes, int start_idx) override;
-    Solution _solve(const Nodes &nodes, int start_idx, int visit_count) override;
-
-protected:
-    std::vector<std::vector<int>> m_distances;
+    Solution _solve(const NodesDistPair &nodes, int start_idx, int visit_count) override;
 };
 
 class GreedyCycleSolver : public NearestNeighbourSolver
 {
+public:
+    // Incremental mode keeps the cheapest insertion of every unvisited node between
+    // steps and produces the same tours as the exhaustive rescan in O(n^2).
+    GreedyCycleSolver(bool incremental = true) : m_incremental(incremental) {}
+
 private:
-    Solution _solve(const Nodes &nodes, int start_idx, int visit_count) override;
+    Solution _solve(const NodesDistPair &nodes, int start_idx, int visit_count) override;
+    Solution solveExhaustive(const NodesDistPair &nodes, int start_idx, int visit_count);
+    Solution solveIncremental(const NodesDistPair &nodes, int start_idx, int visit_count);
+
+protected:
+    bool m_incremental;
 };
 
 class GreedyTwoRegretSolver : public GreedyCycleSolver
 {
 public:
-    GreedyTwoRegretSolver(double first_weight, double second_weight) : m_first_weight(first_weight), m_second_weight(second_weight) {}
+    // Incremental mode caches the two cheapest insertions of every unvisited node
+    // and selects the next node from an indexed heap keyed on weighted regret.
+    GreedyTwoRegretSolver(double first_weight, double second_weight, bool incremental = true)
+        : GreedyCycleSolver(incremental), m_first_weight(first_weight), m_second_weight(second_weight) {}
 
 private:
-    Solution _solve(const Nodes &nodes, int start_idx, int visit_count) override;
+    Solution _solve(const NodesDistPair &nodes, int start_idx, int visit_count) override;
+    Solution solveExhaustive(const NodesDistPair &nodes, int start_idx, int visit_count);
+    Solution solveIncremental(const NodesDistPair &nodes, int start_idx, int visit_count);
+    int regret(int min_increase, int second_min_increase) const;
 
     double m_first_weight;
     double m_second_weight;
 };
 
-std::unique_ptr<AbstractSolver> createSolver(char name, double weigth1, double weight2);
\ No newline at end of file
+std::unique_ptr<AbstractSolver> createSolver(char name, double weigth1, double weight2, Rng &rng);
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "node.hpp"
+#include <vector>
+
+// k-d tree over node coordinates. Queries rank nodes by the same score the
+// constructors use: distance to the query node plus the node weight, with
+// ties broken by the lower node index.
+class SpatialIndex
+{
+public:
+    explicit SpatialIndex(const Nodes &nodes);
+
+    // k best nodes for the given node, the node itself excluded, best first.
+    std::vector<int> kNearest(int node, int k) const;
+
+    // Best active node for the given node, -1 if no other node is active.
+    int nearestActive(int node) const;
+
+    // All nodes start active, deactivation removes a node from nearestActive.
+    void deactivate(int node);
+    void activate(int node);
+    bool isActive(int node) const noexcept { return m_active[node]; }
+
+private:
+    struct Box
+    {
+        int min_x;
+        int max_x;
+        int min_y;
+        int max_y;
+    };
+
+    struct Candidate
+    {
+        int score;
+        int node;
+
+        bool operator<(const Candidate &other) const noexcept
+        {
+            return score < other.score || (score == other.score && node < other.node);
+        }
+    };
+
+    int build(int lo, int hi);
+    void search(int lo, int hi, const Node &query, int excluded, bool active_only, int k, std::vector<Candidate> &best) const;
+    void setActive(int node, bool active);
+    int refreshActiveWeight(int lo, int hi, int position);
+    int lowerBound(const Box &box, const Node &query) const noexcept;
+
+    const Nodes &m_nodes;
+    // Tree nodes are identified by the position of their pivot in m_order.
+    std::vector<int> m_order;
+    std::vector<int> m_position;
+    std::vector<Box> m_boxes;
+    std::vector<bool> m_split_x;
+    std::vector<int> m_min_weight;
+    std::vector<int> m_min_active_weight;
+    std::vector<bool> m_active;
+};
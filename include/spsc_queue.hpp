@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded queue between one producer and one consumer thread. Neither side blocks or
+// takes a lock: each only advances its own index and reads the other's, so a push
+// fails when the queue is full and a pop when it is empty.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(int capacity) : m_slots(capacity + 1) {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    bool tryPush(const T &value)
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        std::size_t next = advance(tail);
+        if (next == m_head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        m_slots[tail] = value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &value)
+    {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = std::move(m_slots[head]);
+        m_head.store(advance(head), std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::size_t advance(std::size_t index) const noexcept
+    {
+        return index + 1 == m_slots.size() ? 0 : index + 1;
+    }
+
+    std::vector<T> m_slots;
+    // the two indices sit on separate cache lines so the threads do not share one
+    alignas(64) std::atomic<std::size_t> m_head = 0;
+    alignas(64) std::atomic<std::size_t> m_tail = 0;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that stay alive between runs. run() hands out the
+// tasks 0..num_tasks-1 one at a time to the workers and the calling thread, and
+// returns once all of them are done.
+class ThreadPool
+{
+public:
+    // num_threads counts the calling thread, so one thread starts no workers.
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const noexcept { return m_workers.size() + 1; }
+    void run(int num_tasks, const std::function<void(int)> &task);
+
+private:
+    void work();
+    void runTasks();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const std::function<void(int)> *m_task = nullptr;
+    int m_num_tasks = 0;
+    int m_next_task = 0;
+    int m_busy = 0;
+    unsigned m_generation = 0;
+    bool m_stopping = false;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "solution.hpp"
+#include <vector>
+
+// A tour together with the index structures the local searches query on every move:
+// the position of each node in the tour, whether it is visited and the list of nodes
+// outside the tour. All of them are kept in sync by the move methods.
+class TourState
+{
+public:
+    static constexpr int OUTSIDE = -1;
+
+    TourState(const Solution &solution, int num_nodes);
+
+    const Solution &tour() const noexcept { return m_tour; }
+    const std::vector<int> &outsideNodes() const noexcept { return m_outside; }
+
+    int size() const noexcept { return m_tour.size(); }
+    int numNodes() const noexcept { return m_position.size(); }
+    int operator[](int idx) const noexcept { return m_tour[idx]; }
+
+    int position(int node) const noexcept { return m_position[node]; }
+    bool contains(int node) const noexcept { return m_in_tour[node]; }
+    int outsideSlot(int node) const noexcept { return m_outside_slot[node]; }
+
+    // Neighbours of a node in the tour and whether middle lies on the way from first to last.
+    int next(int node) const noexcept { return m_tour[m_position[node] + 1 == size() ? 0 : m_position[node] + 1]; }
+    int prev(int node) const noexcept { return m_tour[m_position[node] == 0 ? size() - 1 : m_position[node] - 1]; }
+    bool between(int first, int middle, int last) const noexcept;
+
+    // Same semantics as the free functions in solution.hpp, except that an edge swap may
+    // reverse the outer side of the tour when it is the shorter one, which leaves the
+    // cycle the same but changes positions. A replaced node takes over the slot of the
+    // inserted one in the outside list.
+    void swapNodes(int first_idx, int second_idx);
+    void replaceNode(int sol_idx, int node_idx);
+    void swapEdges(int first_idx, int second_idx);
+    void moveSegment(int first_idx, int length, int target_idx, bool reversed);
+
+    // Node based forms of swapEdges and replaceNode, shared with TwoLevelList.
+    void reversePath(int from, int to);
+    void replace(int old_node, int new_node) { replaceNode(m_position[old_node], new_node); }
+
+private:
+    Solution m_tour;
+    std::vector<int> m_position;
+    std::vector<bool> m_in_tour;
+    std::vector<int> m_outside;
+    std::vector<int> m_outside_slot;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "solution.hpp"
+#include <vector>
+
+// Tour stored as a cyclic list of segments of about sqrt(n) nodes, each with its own
+// reversal bit. Reversing a path splits at most two segments and then only relinks and
+// flips whole segments, so it costs O(sqrt(n)) instead of O(n). Nodes have no fixed
+// position; the tour is navigated with next, prev and between.
+class TwoLevelList
+{
+public:
+    static constexpr int OUTSIDE = -1;
+
+    TwoLevelList(const Solution &solution, int num_nodes);
+
+    // The tour in forward order, starting at an arbitrary node.
+    Solution tour() const;
+    const std::vector<int> &outsideNodes() const noexcept { return m_outside; }
+
+    int size() const noexcept { return m_size; }
+    int numNodes() const noexcept { return m_parent.size(); }
+    bool contains(int node) const noexcept { return m_parent[node] != OUTSIDE; }
+
+    int next(int node) const noexcept;
+    int prev(int node) const noexcept;
+    // Whether middle lies on the forward path from first to last.
+    bool between(int first, int middle, int last) const noexcept;
+
+    // Reverses the forward path from..to, which replaces the edges (prev(from), from)
+    // and (to, next(to)) with (prev(from), to) and (from, next(to)).
+    void reversePath(int from, int to);
+    // The new node takes the place of the old one, which takes the slot of the new one
+    // in the outside list.
+    void replace(int old_node, int new_node);
+
+private:
+    struct Segment
+    {
+        bool reversed;
+        // ends in the stored order, which is the forward order unless reversed
+        int first;
+        int last;
+        int next;
+        int prev;
+        int rank;
+    };
+
+    void build(const Solution &order);
+    void renumber();
+    int head(int segment) const noexcept;
+    int tail(int segment) const noexcept;
+    int offset(int node) const noexcept;
+    void splitBefore(int node);
+    void reverseWithin(int segment, int from, int to);
+    void reverseSegments(int first_segment, int last_segment);
+
+    int m_size;
+    int m_max_segments = 0;
+    // stored order inside a segment, -1 at the segment ends
+    std::vector<int> m_next;
+    std::vector<int> m_prev;
+    std::vector<int> m_parent;
+    std::vector<int> m_id;
+    std::vector<Segment> m_segments;
+    std::vector<int> m_outside;
+    std::vector<int> m_outside_slot;
+    std::vector<int> m_scratch;
+};
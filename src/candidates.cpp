@@ -0,0 +1,181 @@
+#include "candidates.hpp"
+#include "spatial_index.hpp"
+
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+CandidateLists::CandidateLists(const Nodes &nodes, int num_candidates)
+    : m_num_nodes(nodes.size()), m_num_candidates(num_candidates)
+{
+    if (num_candidates > m_num_nodes - 1)
+    {
+        throw std::runtime_error("Too many candidates, max is " + std::to_string(m_num_nodes - 1));
+    }
+    if (num_candidates < 1)
+    {
+        throw std::runtime_error("Too few candidates, min is 1");
+    }
+
+    SpatialIndex index(nodes);
+    m_candidates.reserve(m_num_nodes * m_num_candidates);
+    for (int i = 0; i < m_num_nodes; ++i)
+    {
+        std::vector<int> closest = index.kNearest(i, m_num_candidates);
+        m_candidates.insert(m_candidates.end(), closest.begin(), closest.end());
+    }
+}
+
+CandidateLists::CandidateLists(int num_nodes, int num_candidates, std::vector<int> candidates)
+    : m_num_nodes(num_nodes), m_num_candidates(num_candidates), m_candidates(std::move(candidates))
+{
+    if (m_candidates.size() != static_cast<std::size_t>(num_nodes) * num_candidates)
+    {
+        throw std::runtime_error("Candidate lists do not match the number of nodes");
+    }
+}
+
+std::uint64_t fingerprintNodes(const Nodes &nodes)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](std::int64_t value)
+    {
+        hash ^= static_cast<std::uint64_t>(value);
+        hash *= 1099511628211ull;
+    };
+    mix(nodes.size());
+    for (const Node &node : nodes)
+    {
+        mix(node.getX());
+        mix(node.getY());
+        mix(node.getWeight());
+    }
+    return hash;
+}
+
+typedef std::pair<std::uint64_t, int> CandidateListsKey;
+
+// Bounded so that a long-running process that sees many instances does not keep
+// all their lists alive; callers holding a shared_ptr keep theirs regardless.
+static const std::size_t max_cached_lists = 16;
+
+static std::mutex cache_mutex;
+static std::map<CandidateListsKey, std::shared_ptr<const CandidateLists>> cache;
+static std::deque<CandidateListsKey> cache_order;
+
+static std::shared_ptr<const CandidateLists> findCached(const CandidateListsKey &key)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(key);
+    return it == cache.end() ? nullptr : it->second;
+}
+
+static std::shared_ptr<const CandidateLists> storeCached(
+    const CandidateListsKey &key,
+    std::shared_ptr<const CandidateLists> lists)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    // another thread may have built the same lists in the meantime
+    auto inserted = cache.emplace(key, std::move(lists));
+    if (inserted.second)
+    {
+        cache_order.push_back(key);
+        if (cache_order.size() > max_cached_lists)
+        {
+            cache.erase(cache_order.front());
+            cache_order.pop_front();
+        }
+    }
+    return inserted.first->second;
+}
+
+std::shared_ptr<const CandidateLists> getCandidateLists(const Nodes &nodes, int num_candidates)
+{
+    CandidateListsKey key{fingerprintNodes(nodes), num_candidates};
+    if (auto cached = findCached(key))
+    {
+        return cached;
+    }
+    return storeCached(key, std::make_shared<const CandidateLists>(nodes, num_candidates));
+}
+
+std::string candidateListsFilename(const std::string &instance_filename, int num_candidates)
+{
+    return instance_filename + ".candidates-" + std::to_string(num_candidates);
+}
+
+static std::shared_ptr<const CandidateLists> readCandidateLists(
+    const std::string &filename,
+    std::uint64_t fingerprint,
+    int num_nodes,
+    int num_candidates)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        return nullptr;
+    }
+    std::uint64_t file_fingerprint;
+    int file_num_nodes, file_num_candidates;
+    if (!(file >> file_fingerprint >> file_num_nodes >> file_num_candidates) ||
+        file_fingerprint != fingerprint ||
+        file_num_nodes != num_nodes ||
+        file_num_candidates != num_candidates)
+    {
+        return nullptr;
+    }
+    std::vector<int> candidates(num_nodes * num_candidates);
+    for (int &candidate : candidates)
+    {
+        if (!(file >> candidate) || candidate < 0 || candidate >= num_nodes)
+        {
+            return nullptr;
+        }
+    }
+    return std::make_shared<const CandidateLists>(num_nodes, num_candidates, std::move(candidates));
+}
+
+static void writeCandidateLists(const std::string &filename, std::uint64_t fingerprint, const CandidateLists &lists)
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+    {
+        // the lists are still usable, they just get rebuilt in the next run
+        std::cerr << "Warning: could not write candidate lists to " << filename << "\n";
+        return;
+    }
+    file << fingerprint << ' ' << lists.numNodes() << ' ' << lists.numCandidates() << '\n';
+    for (int i = 0; i < lists.numNodes(); ++i)
+    {
+        for (int candidate : lists[i])
+        {
+            file << candidate << ' ';
+        }
+        file << '\n';
+    }
+}
+
+std::shared_ptr<const CandidateLists> loadCandidateLists(
+    const Nodes &nodes,
+    int num_candidates,
+    const std::string &instance_filename)
+{
+    std::uint64_t fingerprint = fingerprintNodes(nodes);
+    CandidateListsKey key{fingerprint, num_candidates};
+    if (auto cached = findCached(key))
+    {
+        return cached;
+    }
+
+    std::string filename = candidateListsFilename(instance_filename, num_candidates);
+    auto lists = readCandidateLists(filename, fingerprint, nodes.size(), num_candidates);
+    if (!lists)
+    {
+        lists = std::make_shared<const CandidateLists>(nodes, num_candidates);
+        writeCandidateLists(filename, fingerprint, *lists);
+    }
+    return storeCached(key, std::move(lists));
+}
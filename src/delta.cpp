@@ -58,11 +58,14 @@ int getEdgesSwapDelta(
     if (first_next == second)
         return 0;
 
+    const auto first_row = nodes.dist[first];
+    const auto first_next_row = nodes.dist[first_next];
+
     int delta = 0;
-    delta += nodes.dist[first][second];
-    delta += nodes.dist[first_next][second_next];
+    delta += first_row[second];
+    delta += first_next_row[second_next];
 
-    delta -= nodes.dist[first][first_next];
+    delta -= first_row[first_next];
     delta -= nodes.dist[second][second_next];
 
     return delta;
@@ -77,13 +80,53 @@ int getReplaceNodeDelta(
     int prev = solution[(sol_idx - 1 + solution.size()) % solution.size()];
     int next = solution[(sol_idx + 1) % solution.size()];
 
+    int current = solution[sol_idx];
+    const auto prev_row = nodes.dist[prev];
+    const auto next_row = nodes.dist[next];
+
     int delta = 0;
-    delta += nodes.dist[prev][node_idx];
-    delta += nodes.dist[node_idx][next];
+    delta += prev_row[node_idx];
+    delta += next_row[node_idx];
     delta += nodes.nodes[node_idx].getWeight();
-    delta -= nodes.nodes[solution[sol_idx]].getWeight();
-    delta -= nodes.dist[prev][solution[sol_idx]];
-    delta -= nodes.dist[solution[sol_idx]][next];
+    delta -= nodes.nodes[current].getWeight();
+    delta -= prev_row[current];
+    delta -= next_row[current];
 
     return delta;
-}
\ No newline at end of file
+}
+
+int getOrOptDelta(
+    const NodesDistPair &nodes,
+    const Solution &solution,
+    int first_idx,
+    int length,
+    int target_idx,
+    bool reversed)
+{
+    int last_idx = first_idx + length - 1;
+    int prev = solution[(first_idx - 1 + solution.size()) % solution.size()];
+    int first = solution[first_idx];
+    int last = solution[last_idx];
+    int next = solution[(last_idx + 1) % solution.size()];
+    int target = solution[target_idx];
+    int target_next = solution[(target_idx + 1) % solution.size()];
+
+    int delta = 0;
+    delta += nodes.dist[prev][next];
+    if (reversed)
+    {
+        delta += nodes.dist[target][last];
+        delta += nodes.dist[first][target_next];
+    }
+    else
+    {
+        delta += nodes.dist[target][first];
+        delta += nodes.dist[last][target_next];
+    }
+
+    delta -= nodes.dist[prev][first];
+    delta -= nodes.dist[last][next];
+    delta -= nodes.dist[target][target_next];
+
+    return delta;
+}
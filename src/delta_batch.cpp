@@ -0,0 +1,242 @@
+#include "delta.hpp"
+
+#include <climits>
+
+// the AVX2 kernels and the runtime check of CPU features exist only on x86
+#if defined(__x86_64__) || defined(__i386__)
+#define DELTA_BATCH_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    struct EdgeRow
+    {
+        const int *tour;
+        int size;
+        int first_idx;
+        const int *first_row;
+        const int *first_next_row;
+        int removed;
+    };
+
+    EdgeRow edgeRow(const NodesDistPair &nodes, const Solution &solution, int first_idx)
+    {
+        int size = solution.size();
+        int first = solution[first_idx];
+        int first_next = solution[first_idx + 1 == size ? 0 : first_idx + 1];
+        const int *first_row = nodes.dist[first].data();
+        return {solution.data(), size, first_idx, first_row, nodes.dist[first_next].data(), first_row[first_next]};
+    }
+
+    struct ReplaceRow
+    {
+        const int *prev_row;
+        const int *next_row;
+        const int *weights;
+        int removed;
+    };
+
+    ReplaceRow replaceRow(const NodesDistPair &nodes, const Solution &solution, int sol_idx)
+    {
+        int size = solution.size();
+        int prev = solution[sol_idx == 0 ? size - 1 : sol_idx - 1];
+        int next = solution[sol_idx + 1 == size ? 0 : sol_idx + 1];
+        int current = solution[sol_idx];
+        const int *prev_row = nodes.dist[prev].data();
+        const int *next_row = nodes.dist[next].data();
+        int removed = nodes.weights[current] + prev_row[current] + next_row[current];
+        return {prev_row, next_row, nodes.weights.data(), removed};
+    }
+
+    // The formula is symmetric in the two indices and gives 0 for neighbouring edges,
+    // so only the swap of an edge with itself needs a special case.
+    int edgeDelta(const NodesDistPair &nodes, const EdgeRow &row, int second_idx)
+    {
+        if (second_idx == row.first_idx)
+        {
+            return 0;
+        }
+        int second = row.tour[second_idx];
+        int second_next = row.tour[second_idx + 1 == row.size ? 0 : second_idx + 1];
+        return row.first_row[second] + row.first_next_row[second_next] - row.removed - nodes.dist[second][second_next];
+    }
+
+    BatchMin minEdgesSwapDeltaScalar(const NodesDistPair &nodes, const Solution &solution, int first_idx, const int *second_idx, int count)
+    {
+        EdgeRow row = edgeRow(nodes, solution, first_idx);
+        BatchMin best{INT_MAX, -1};
+        for (int k = 0; k < count; ++k)
+        {
+            int delta = edgeDelta(nodes, row, second_idx[k]);
+            if (delta < best.delta)
+            {
+                best = {delta, k};
+            }
+        }
+        return best;
+    }
+
+    BatchMin minReplaceNodeDeltaScalar(const NodesDistPair &nodes, const Solution &solution, int sol_idx, const int *node_idx, int count)
+    {
+        ReplaceRow row = replaceRow(nodes, solution, sol_idx);
+        BatchMin best{INT_MAX, -1};
+        for (int k = 0; k < count; ++k)
+        {
+            int node = node_idx[k];
+            int delta = row.prev_row[node] + row.next_row[node] + row.weights[node] - row.removed;
+            if (delta < best.delta)
+            {
+                best = {delta, k};
+            }
+        }
+        return best;
+    }
+
+#ifdef DELTA_BATCH_X86
+    // Lane-wise minima are kept with the first batch position they came from, so the
+    // reduction picks the same move as a sequential scan.
+    __attribute__((target("avx2"))) BatchMin reduceLanes(__m256i best, __m256i best_index)
+    {
+        alignas(32) int deltas[8];
+        alignas(32) int indices[8];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(deltas), best);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(indices), best_index);
+        BatchMin result{INT_MAX, -1};
+        for (int lane = 0; lane < 8; ++lane)
+        {
+            if (deltas[lane] < result.delta || (deltas[lane] == result.delta && indices[lane] < result.index))
+            {
+                result = {deltas[lane], indices[lane]};
+            }
+        }
+        return result;
+    }
+
+    __attribute__((target("avx2"))) BatchMin minEdgesSwapDeltaAvx2(const NodesDistPair &nodes, const Solution &solution, int first_idx, const int *second_idx, int count)
+    {
+        EdgeRow row = edgeRow(nodes, solution, first_idx);
+        const int *dist = nodes.dist.data();
+        const __m256i size = _mm256_set1_epi32(row.size);
+        const __m256i first = _mm256_set1_epi32(first_idx);
+        const __m256i stride = _mm256_set1_epi32(nodes.dist.stride());
+        const __m256i removed = _mm256_set1_epi32(row.removed);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i step = _mm256_set1_epi32(8);
+        __m256i best = _mm256_set1_epi32(INT_MAX);
+        __m256i best_index = _mm256_set1_epi32(-1);
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        int k = 0;
+        for (; k + 8 <= count; k += 8)
+        {
+            __m256i second_pos = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(second_idx + k));
+            __m256i next_pos = _mm256_add_epi32(second_pos, one);
+            next_pos = _mm256_andnot_si256(_mm256_cmpeq_epi32(next_pos, size), next_pos);
+            __m256i second = _mm256_i32gather_epi32(row.tour, second_pos, 4);
+            __m256i second_next = _mm256_i32gather_epi32(row.tour, next_pos, 4);
+
+            __m256i delta = _mm256_add_epi32(
+                _mm256_i32gather_epi32(row.first_row, second, 4),
+                _mm256_i32gather_epi32(row.first_next_row, second_next, 4));
+            __m256i second_edge = _mm256_i32gather_epi32(dist, _mm256_add_epi32(_mm256_mullo_epi32(second, stride), second_next), 4);
+            delta = _mm256_sub_epi32(delta, _mm256_add_epi32(removed, second_edge));
+            delta = _mm256_andnot_si256(_mm256_cmpeq_epi32(second_pos, first), delta);
+
+            __m256i better = _mm256_cmpgt_epi32(best, delta);
+            best = _mm256_blendv_epi8(best, delta, better);
+            best_index = _mm256_blendv_epi8(best_index, index, better);
+            index = _mm256_add_epi32(index, step);
+        }
+
+        BatchMin result = reduceLanes(best, best_index);
+        for (; k < count; ++k)
+        {
+            int delta = edgeDelta(nodes, row, second_idx[k]);
+            if (delta < result.delta)
+            {
+                result = {delta, k};
+            }
+        }
+        return result;
+    }
+
+    __attribute__((target("avx2"))) BatchMin minReplaceNodeDeltaAvx2(const NodesDistPair &nodes, const Solution &solution, int sol_idx, const int *node_idx, int count)
+    {
+        ReplaceRow row = replaceRow(nodes, solution, sol_idx);
+        const __m256i removed = _mm256_set1_epi32(row.removed);
+        const __m256i step = _mm256_set1_epi32(8);
+        __m256i best = _mm256_set1_epi32(INT_MAX);
+        __m256i best_index = _mm256_set1_epi32(-1);
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        int k = 0;
+        for (; k + 8 <= count; k += 8)
+        {
+            __m256i node = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(node_idx + k));
+            __m256i delta = _mm256_add_epi32(
+                _mm256_i32gather_epi32(row.prev_row, node, 4),
+                _mm256_i32gather_epi32(row.next_row, node, 4));
+            delta = _mm256_add_epi32(delta, _mm256_i32gather_epi32(row.weights, node, 4));
+            delta = _mm256_sub_epi32(delta, removed);
+
+            __m256i better = _mm256_cmpgt_epi32(best, delta);
+            best = _mm256_blendv_epi8(best, delta, better);
+            best_index = _mm256_blendv_epi8(best_index, index, better);
+            index = _mm256_add_epi32(index, step);
+        }
+
+        BatchMin result = reduceLanes(best, best_index);
+        for (; k < count; ++k)
+        {
+            int node = node_idx[k];
+            int delta = row.prev_row[node] + row.next_row[node] + row.weights[node] - row.removed;
+            if (delta < result.delta)
+            {
+                result = {delta, k};
+            }
+        }
+        return result;
+    }
+
+    const bool use_avx2 = []
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+#else
+    const bool use_avx2 = false;
+#endif
+}
+
+BatchMin minEdgesSwapDelta(const NodesDistPair &nodes, const Solution &solution, int first_idx, const int *second_idx, int count)
+{
+#ifdef DELTA_BATCH_X86
+    if (use_avx2 && edgeSwapGatherFits(nodes.dist.size(), nodes.dist.stride()))
+    {
+        return minEdgesSwapDeltaAvx2(nodes, solution, first_idx, second_idx, count);
+    }
+#endif
+    return minEdgesSwapDeltaScalar(nodes, solution, first_idx, second_idx, count);
+}
+
+BatchMin minReplaceNodeDelta(const NodesDistPair &nodes, const Solution &solution, int sol_idx, const int *node_idx, int count)
+{
+#ifdef DELTA_BATCH_X86
+    if (use_avx2)
+    {
+        return minReplaceNodeDeltaAvx2(nodes, solution, sol_idx, node_idx, count);
+    }
+#endif
+    return minReplaceNodeDeltaScalar(nodes, solution, sol_idx, node_idx, count);
+}
+
+bool batchKernelsUseAvx2()
+{
+    return use_avx2;
+}
+
+bool edgeSwapGatherFits(std::size_t num_rows, std::size_t stride)
+{
+    return num_rows * stride <= INT_MAX;
+}
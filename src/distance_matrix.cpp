@@ -0,0 +1,31 @@
+#include "distance_matrix.hpp"
+
+#include <stdexcept>
+
+constexpr static std::size_t INTS_PER_LINE = DistanceMatrix::ALIGNMENT / sizeof(int);
+
+DistanceMatrix::DistanceMatrix(std::size_t size)
+    : m_size(size),
+      m_stride((size + INTS_PER_LINE - 1) / INTS_PER_LINE * INTS_PER_LINE),
+      m_data(m_size * m_stride, 0)
+{
+}
+
+DistanceMatrix::DistanceMatrix(std::initializer_list<std::initializer_list<int>> rows)
+    : DistanceMatrix(rows.size())
+{
+    std::size_t i = 0;
+    for (const auto &row : rows)
+    {
+        if (row.size() != m_size)
+        {
+            throw std::runtime_error("Distance matrix has to be square");
+        }
+        std::size_t j = 0;
+        for (int value : row)
+        {
+            (*this)[i][j++] = value;
+        }
+        ++i;
+    }
+}
@@ -1,42 +1,285 @@
 #include "improvers.hpp"
 #include "solvers.hpp"
 #include "random.hpp"
+#include "candidates.hpp"
+#include "two_level_list.hpp"
+#include "move_cache.hpp"
+#include "spsc_queue.hpp"
 
+#include <climits>
 #include <cmath>
+#include <exception>
 #include <iostream>
 #include <set>
 #include <queue>
 #include <chrono>
 #include <numeric>
+#include <thread>
 
-constexpr static unsigned int VAL_BITS = 15;
-constexpr static unsigned int TYPE_MASK = 0b11 << (VAL_BITS * 2);
-constexpr static unsigned int FIRST_VAL_MASK = ((1 << VAL_BITS) - 1) << VAL_BITS;
-constexpr static unsigned int SECOND_VAL_MASK = ~(TYPE_MASK | FIRST_VAL_MASK);
-constexpr static int MAX_VAL = (1 << VAL_BITS) - 1;
+constexpr static unsigned int SEGMENT_BITS = 3;
 
-OpData::OpData(int operation)
+// Field layout of a move packed into Word: the type in the top 2 bits and the two
+// indices in equal halves of the rest.
+template <typename Word>
+struct Packing
 {
-    m_type = static_cast<OperationType>((operation & TYPE_MASK) >> (VAL_BITS * 2));
-    m_first_idx = (operation & FIRST_VAL_MASK) >> VAL_BITS;
-    m_second_idx = operation & SECOND_VAL_MASK;
+    constexpr static unsigned int VAL_BITS = (sizeof(Word) * 8 - 2) / 2;
+    constexpr static unsigned int TYPE_SHIFT = VAL_BITS * 2;
+    constexpr static Word VAL_MASK = (Word(1) << VAL_BITS) - 1;
+    constexpr static Word TYPE_MASK = Word(0b11) << TYPE_SHIFT;
+    constexpr static Word FIRST_VAL_MASK = VAL_MASK << VAL_BITS;
+    constexpr static Word SECOND_VAL_MASK = VAL_MASK;
+    constexpr static long long MAX_VAL = VAL_MASK;
+    constexpr static long long MAX_OR_OPT_TARGET = MAX_VAL >> SEGMENT_BITS;
+};
+
+template <typename Word>
+static OperationType typeOf(Word operation)
+{
+    return static_cast<OperationType>((operation & Packing<Word>::TYPE_MASK) >> Packing<Word>::TYPE_SHIFT);
+}
+
+template <typename Word>
+static Word encodeMove(const OpData &op)
+{
+    Word second = op.m_second_idx;
+    if (op.m_type == OperationType::OR_OPT)
+    {
+        second = (second << SEGMENT_BITS) | ((op.m_length - 1) << 1) | op.m_reversed;
+    }
+    return (static_cast<Word>(op.m_type) << Packing<Word>::TYPE_SHIFT) |
+           (static_cast<Word>(op.m_first_idx) << Packing<Word>::VAL_BITS) |
+           second;
 }
 
-int OpData::toInt() const
+template <typename Word>
+static OpData decodeMove(Word operation)
 {
-    return (static_cast<int>(m_type) << (VAL_BITS * 2)) | (m_first_idx << VAL_BITS) | m_second_idx;
+    OperationType type = typeOf(operation);
+    int first_idx = (operation & Packing<Word>::FIRST_VAL_MASK) >> Packing<Word>::VAL_BITS;
+    int second_idx = operation & Packing<Word>::SECOND_VAL_MASK;
+    if (type == OperationType::OR_OPT)
+    {
+        return OpData(type, first_idx, second_idx >> SEGMENT_BITS, ((second_idx >> 1) & 0b11) + 1, second_idx & 1);
+    }
+    return OpData(type, first_idx, second_idx);
+}
+
+// Delta of a packed move whose type is known at compile time, without decoding it
+// into an OpData first.
+template <OperationType Type, typename Word>
+static int evaluateMove(Word operation, const Solution &solution, const NodesDistPair &nodes)
+{
+    int first_idx = (operation & Packing<Word>::FIRST_VAL_MASK) >> Packing<Word>::VAL_BITS;
+    int second_idx = operation & Packing<Word>::SECOND_VAL_MASK;
+    if constexpr (Type == OperationType::NODE_SWAP)
+    {
+        return getNodesSwapDelta(nodes, solution, first_idx, second_idx);
+    }
+    else if constexpr (Type == OperationType::EDGE_SWAP)
+    {
+        return getEdgesSwapDelta(nodes, solution, first_idx, second_idx);
+    }
+    else if constexpr (Type == OperationType::NODE_REPLACE)
+    {
+        return getReplaceNodeDelta(nodes, solution, first_idx, second_idx);
+    }
+    else
+    {
+        static_assert(Type == OperationType::OR_OPT);
+        return getOrOptDelta(nodes, solution, first_idx, ((second_idx >> 1) & 0b11) + 1,
+                             second_idx >> SEGMENT_BITS, second_idx & 1);
+    }
+}
+
+// Or-opt moves of segments of Length nodes starting in [begin, end), in the order of
+// the full scan: by first position, target and direction. closed is the tour followed by its first node, and
+// the targets touching the segment are skipped by splitting the range instead of
+// testing every one.
+template <int Length>
+static void findBestOrOpt(const Solution &closed, const NodesDistPair &nodes, int begin, int end, int &best_delta, OpData &best_op)
+{
+    const auto &dist = nodes.dist;
+    const int size = closed.size() - 1;
+    for (int i = begin; i < end && i + Length <= size; ++i)
+    {
+        int prev = closed[i == 0 ? size - 1 : i - 1];
+        int first = closed[i];
+        int last = closed[i + Length - 1];
+        int next = closed[i + Length];
+        int removed = dist[prev][next] - dist[prev][first] - dist[last][next];
+        const auto first_row = dist[first];
+        const auto last_row = dist[last];
+
+        auto scan = [&](int from, int to)
+        {
+            for (int j = from; j < to; ++j)
+            {
+                int target = closed[j];
+                int target_next = closed[j + 1];
+                int kept = removed - dist[target][target_next];
+                int delta = kept + first_row[target] + last_row[target_next];
+                if (delta < best_delta)
+                {
+                    best_delta = delta;
+                    best_op = OpData(OperationType::OR_OPT, i, j, Length, false);
+                }
+                if constexpr (Length > 1)
+                {
+                    delta = kept + last_row[target] + first_row[target_next];
+                    if (delta < best_delta)
+                    {
+                        best_delta = delta;
+                        best_op = OpData(OperationType::OR_OPT, i, j, Length, true);
+                    }
+                }
+            }
+        };
+        if (i == 0)
+        {
+            scan(Length, size - 1);
+        }
+        else
+        {
+            scan(0, i - 1);
+            scan(i + Length, size);
+        }
+    }
 }
 
-Solution OpData::apply(Solution &sol) const
+struct ScanBest
+{
+    int delta = 0;
+    OpData op = OpData(OperationType::FORBIDDEN, 0, 0);
+};
+
+// node swaps, edge swaps, or-opt for each segment length and replacements
+constexpr static int SCAN_PHASES = 3 + MAX_SEGMENT_LENGTH;
+
+// Best move of each phase of the full scan among the moves of rows [begin, end).
+static void scanRows(
+    const TourState &state,
+    const NodesDistPair &nodes,
+    NeighborhoodType type,
+    const Solution &closed,
+    const std::vector<int> &positions,
+    int begin,
+    int end,
+    ScanBest *best)
+{
+    const Solution &tour = state.tour();
+    const std::vector<int> &outside = state.outsideNodes();
+    const int size = tour.size();
+    std::fill(best, best + SCAN_PHASES, ScanBest());
+
+    if (includesNodeSwaps(type))
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            for (int j = i + 1; j < size; ++j)
+            {
+                int delta = getNodesSwapDelta(nodes, tour, i, j);
+                if (delta < best[0].delta)
+                {
+                    best[0] = {delta, OpData(OperationType::NODE_SWAP, i, j)};
+                }
+            }
+        }
+    }
+
+    if (includesEdgeSwaps(type))
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            // the first and the last edge are neighbours
+            int count = size - i - 2 - (i == 0 ? 1 : 0);
+            if (count <= 0)
+            {
+                continue;
+            }
+            BatchMin batch = minEdgesSwapDelta(nodes, tour, i, positions.data() + i + 2, count);
+            if (batch.delta < best[1].delta)
+            {
+                best[1] = {batch.delta, OpData(OperationType::EDGE_SWAP, i, i + 2 + batch.index)};
+            }
+        }
+    }
+
+    if (includesOrOpt(type))
+    {
+        static_assert(MAX_SEGMENT_LENGTH == 3);
+        findBestOrOpt<1>(closed, nodes, begin, end, best[2].delta, best[2].op);
+        findBestOrOpt<2>(closed, nodes, begin, end, best[3].delta, best[3].op);
+        findBestOrOpt<3>(closed, nodes, begin, end, best[4].delta, best[4].op);
+    }
+
+    for (int i = begin; i < end; ++i)
+    {
+        BatchMin batch = minReplaceNodeDelta(nodes, tour, i, outside.data(), outside.size());
+        if (batch.delta < best[5].delta)
+        {
+            best[5] = {batch.delta, OpData(OperationType::NODE_REPLACE, i, outside[batch.index])};
+        }
+    }
+}
+
+OpData::OpData(Operation operation)
+    : OpData(decodeMove(operation))
+{
+}
+
+Operation OpData::toInt() const
+{
+    return encodeMove<Operation>(*this);
+}
+
+OpData OpData::fromCompact(CompactOperation operation)
+{
+    return decodeMove(operation);
+}
+
+CompactOperation OpData::toCompact() const
+{
+    return encodeMove<CompactOperation>(*this);
+}
+
+void OpData::apply(Solution &sol) const
 {
     switch (m_type)
     {
     case OperationType::NODE_SWAP:
-        return swapNodes(sol, m_first_idx, m_second_idx);
+        swapNodes(sol, m_first_idx, m_second_idx);
+        break;
     case OperationType::EDGE_SWAP:
-        return swapEdges(sol, m_first_idx, m_second_idx);
+        swapEdges(sol, m_first_idx, m_second_idx);
+        break;
     case OperationType::NODE_REPLACE:
-        return replaceNode(sol, m_first_idx, m_second_idx);
+        replaceNode(sol, m_first_idx, m_second_idx);
+        break;
+    case OperationType::OR_OPT:
+        moveSegment(sol, m_first_idx, m_length, m_second_idx, m_reversed);
+        break;
+    default:
+        throw std::runtime_error("Apply: Forbidden operation");
+    }
+}
+
+void OpData::apply(TourState &state) const
+{
+    switch (m_type)
+    {
+    case OperationType::NODE_SWAP:
+        state.swapNodes(m_first_idx, m_second_idx);
+        break;
+    case OperationType::EDGE_SWAP:
+        state.swapEdges(m_first_idx, m_second_idx);
+        break;
+    case OperationType::NODE_REPLACE:
+        state.replaceNode(m_first_idx, m_second_idx);
+        break;
+    case OperationType::OR_OPT:
+        state.moveSegment(m_first_idx, m_length, m_second_idx, m_reversed);
+        break;
     default:
         throw std::runtime_error("Apply: Forbidden operation");
     }
@@ -52,6 +295,8 @@ int OpData::evaluate(const Solution &sol, const NodesDistPair &nodes) const
         return getEdgesSwapDelta(nodes, sol, m_first_idx, m_second_idx);
     case OperationType::NODE_REPLACE:
         return getReplaceNodeDelta(nodes, sol, m_first_idx, m_second_idx);
+    case OperationType::OR_OPT:
+        return getOrOptDelta(nodes, sol, m_first_idx, m_length, m_second_idx, m_reversed);
     default:
         throw std::runtime_error("Evaluate: Forbidden operation");
     }
@@ -72,6 +317,11 @@ bool OpData::isApplicable(const Solution &solution) const
     return true;
 }
 
+bool OpData::isApplicable(const TourState &state) const
+{
+    return m_type != OperationType::NODE_REPLACE || !state.contains(m_second_idx);
+}
+
 void OpData::print() const
 {
     switch (m_type)
@@ -85,6 +335,9 @@ void OpData::print() const
     case OperationType::NODE_REPLACE:
         std::cout << "Node Replace:\t";
         break;
+    case OperationType::OR_OPT:
+        std::cout << "Or-opt " << m_length << (m_reversed ? " reversed" : "") << ":\t";
+        break;
     default:
         std::cout << "FORBIDDEN:\t";
         break;
@@ -112,43 +365,73 @@ std::vector<int> findMissingNumbers(const std::vector<int> &A, int N)
     return missing_numbers;
 }
 
-std::vector<int> getNeighborhoodOperations(
-    const Solution &solution,
-    int num_nodes,
-    NeighborhoodType type)
+// Whether the segment of the given length at first_idx can be moved behind target_idx.
+static bool isOrOptTarget(int tour_size, int first_idx, int length, int target_idx)
 {
-    if (num_nodes > MAX_VAL)
+    // the target edge may not touch the segment
+    int offset = (target_idx - first_idx + 1 + tour_size) % tour_size;
+    return offset > length;
+}
+
+static std::size_t countOrOptMoves(std::size_t tour_size)
+{
+    std::size_t count = 0;
+    for (std::size_t length = 1; length <= MAX_SEGMENT_LENGTH; ++length)
     {
-        throw std::runtime_error("Too many nodes, max is " + std::to_string(MAX_VAL));
+        if (tour_size < length + 1)
+        {
+            break;
+        }
+        std::size_t directions = length > 1 ? 2 : 1;
+        count += (tour_size - length + 1) * (tour_size - length - 1) * directions;
+    }
+    return count;
+}
+
+template <typename Word>
+static std::vector<Word> neighborhoodOperations(const Solution &solution, int num_nodes, NeighborhoodType type)
+{
+    if (num_nodes > Packing<Word>::MAX_VAL)
+    {
+        throw std::runtime_error("Too many nodes, max is " + std::to_string(Packing<Word>::MAX_VAL));
+    }
+
+    if (includesOrOpt(type) && solution.size() > Packing<Word>::MAX_OR_OPT_TARGET)
+    {
+        throw std::runtime_error("Tour too long for or-opt moves, max is " + std::to_string(Packing<Word>::MAX_OR_OPT_TARGET));
     }
 
     std::vector<int> nodes_outside_solution = findMissingNumbers(solution, num_nodes);
 
-    int num_operations = 0;
+    std::size_t num_operations = 0;
 
-    int s_choose_2 = (solution.size() * (solution.size() - 1)) / 2;
+    std::size_t s_choose_2 = (solution.size() * (solution.size() - 1)) / 2;
 
-    if (type != NeighborhoodType::EDGE)
+    if (includesNodeSwaps(type))
     {
         // |s| choose 2 for node swaps
         num_operations += s_choose_2;
     }
 
-    if (type != NeighborhoodType::NODE)
+    if (includesEdgeSwaps(type))
     {
         // |s| choose 2 - |s| for edge swaps
         num_operations += s_choose_2 - solution.size();
     }
 
+    if (includesOrOpt(type))
+    {
+        num_operations += countOrOptMoves(solution.size());
+    }
+
     // |s| * |n| for node replacements
     num_operations += solution.size() * nodes_outside_solution.size();
 
-    int invalid_operation = static_cast<int>(OperationType::FORBIDDEN) << (VAL_BITS * 2);
-    std::vector<int> operations(num_operations, invalid_operation);
+    std::vector<Word> operations(num_operations);
 
-    int op_idx = -1;
+    std::ptrdiff_t op_idx = -1;
 
-    if (type != NeighborhoodType::EDGE)
+    if (includesNodeSwaps(type))
     {
 
         for (int i = 0; i < solution.size(); ++i)
@@ -156,11 +439,11 @@ std::vector<int> getNeighborhoodOperations(
             for (int j = i + 1; j < solution.size(); ++j)
             {
                 OpData op(OperationType::NODE_SWAP, i, j);
-                operations[++op_idx] = op.toInt();
+                operations[++op_idx] = encodeMove<Word>(op);
             }
         }
     }
-    if (type != NeighborhoodType::NODE)
+    if (includesEdgeSwaps(type))
     {
         for (int i = 0; i < solution.size(); ++i)
         {
@@ -171,7 +454,28 @@ std::vector<int> getNeighborhoodOperations(
                     continue;
                 }
                 OpData op(OperationType::EDGE_SWAP, i, j);
-                operations[++op_idx] = op.toInt();
+                operations[++op_idx] = encodeMove<Word>(op);
+            }
+        }
+    }
+    if (includesOrOpt(type))
+    {
+        for (int length = 1; length <= MAX_SEGMENT_LENGTH; ++length)
+        {
+            for (int i = 0; i + length <= solution.size(); ++i)
+            {
+                for (int j = 0; j < solution.size(); ++j)
+                {
+                    if (!isOrOptTarget(solution.size(), i, length, j))
+                    {
+                        continue;
+                    }
+                    operations[++op_idx] = encodeMove<Word>(OpData(OperationType::OR_OPT, i, j, length, false));
+                    if (length > 1)
+                    {
+                        operations[++op_idx] = encodeMove<Word>(OpData(OperationType::OR_OPT, i, j, length, true));
+                    }
+                }
             }
         }
     }
@@ -181,59 +485,123 @@ std::vector<int> getNeighborhoodOperations(
         for (int j : nodes_outside_solution)
         {
             OpData op(OperationType::NODE_REPLACE, i, j);
-            operations[++op_idx] = op.toInt();
+            operations[++op_idx] = encodeMove<Word>(op);
         }
     }
 
     return operations;
 }
 
-std::vector<int> AbstractImprover::generateOperationsVector(const Solution &solution, const NodesDistPair &nodes)
+std::vector<Operation> getNeighborhoodOperations(
+    const Solution &solution,
+    int num_nodes,
+    NeighborhoodType type)
+{
+    return neighborhoodOperations<Operation>(solution, num_nodes, type);
+}
+
+bool fitsCompactOperation(int tour_size, int num_nodes, NeighborhoodType type)
 {
-    return getNeighborhoodOperations(solution, nodes.nodes.size(), m_ntype);
+    return num_nodes <= Packing<CompactOperation>::MAX_VAL &&
+           (!includesOrOpt(type) || tour_size <= Packing<CompactOperation>::MAX_OR_OPT_TARGET);
 }
 
-void AbstractImprover::updateOperationsVector(
-    std::vector<int> &operations,
-    const Solution &solution,
-    const OpData &selected_operation) const
+Solution GreedyImprover::improve(Solution &solution, const NodesDistPair &nodes)
 {
-    if (selected_operation.m_type != OperationType::NODE_REPLACE)
+    TourState state(solution, nodes.nodes.size());
+    if (fitsCompactOperation(state.size(), state.numNodes(), m_ntype))
     {
-        return;
+        descend<CompactOperation>(state, nodes);
     }
-    int new_node = selected_operation.m_second_idx;
-    int old_node = solution[selected_operation.m_first_idx];
-    int op_node;
-    OperationType op_type;
-    for (int i = 0; i < operations.size(); ++i)
+    else
+    {
+        descend<Operation>(state, nodes);
+    }
+    solution = state.tour();
+    return solution;
+}
+
+template <typename Word>
+void GreedyImprover::descend(TourState &state, const NodesDistPair &nodes)
+{
+    std::vector<Word> operations = neighborhoodOperations<Word>(state.tour(), state.numNodes(), m_ntype);
+
+    // replacements address the outside list by slot, which a replaced node takes over
+    // from the inserted one, so they stay valid without any update
+    for (Word &operation : operations)
     {
-        op_node = operations[i] & SECOND_VAL_MASK;
-        op_type = static_cast<OperationType>((operations[i] & TYPE_MASK) >> (VAL_BITS * 2));
-        if (op_node == new_node && op_type == OperationType::NODE_REPLACE)
+        OpData op = decodeMove(operation);
+        if (op.m_type == OperationType::NODE_REPLACE)
         {
-            operations[i] = (operations[i] & ~SECOND_VAL_MASK) | old_node;
+            operation = encodeMove<Word>(OpData(OperationType::NODE_REPLACE, op.m_first_idx, state.outsideSlot(op.m_second_idx)));
         }
     }
+
+    switch (m_ntype)
+    {
+    case NeighborhoodType::NODE:
+        descend<NeighborhoodType::NODE>(state, operations, nodes);
+        break;
+    case NeighborhoodType::EDGE:
+        descend<NeighborhoodType::EDGE>(state, operations, nodes);
+        break;
+    case NeighborhoodType::BOTH:
+        descend<NeighborhoodType::BOTH>(state, operations, nodes);
+        break;
+    case NeighborhoodType::OR_OPT:
+        descend<NeighborhoodType::OR_OPT>(state, operations, nodes);
+        break;
+    }
 }
 
-Solution GreedyImprover::improve(Solution &solution, const NodesDistPair &nodes)
+template <NeighborhoodType NType, typename Word>
+void GreedyImprover::descend(TourState &state, std::vector<Word> &operations, const NodesDistPair &nodes)
 {
-    std::vector<int> operations = generateOperationsVector(solution, nodes);
-    OpData selected_operation = OpData(OperationType::FORBIDDEN, 0, 0);
+    // only the move types of the neighborhood are tested for
+    auto evaluate = [&](Word operation)
+    {
+        const Solution &tour = state.tour();
+        OperationType type = typeOf(operation);
+        if constexpr (includesNodeSwaps(NType))
+        {
+            if (type == OperationType::NODE_SWAP)
+            {
+                return evaluateMove<OperationType::NODE_SWAP>(operation, tour, nodes);
+            }
+        }
+        if constexpr (includesOrOpt(NType))
+        {
+            if (type == OperationType::OR_OPT)
+            {
+                return evaluateMove<OperationType::OR_OPT>(operation, tour, nodes);
+            }
+        }
+        if constexpr (includesEdgeSwaps(NType))
+        {
+            if (type == OperationType::EDGE_SWAP)
+            {
+                return evaluateMove<OperationType::EDGE_SWAP>(operation, tour, nodes);
+            }
+        }
+        Word slot = operation & Packing<Word>::SECOND_VAL_MASK;
+        return evaluateMove<OperationType::NODE_REPLACE>(Word(operation - slot + state.outsideNodes()[slot]), tour, nodes);
+    };
 
     while (true)
     {
-        std::shuffle(operations.begin(), operations.end(), m_rng);
-        selected_operation = OpData(OperationType::FORBIDDEN, 0, 0);
-        for (int operation : operations)
+        // Fisher-Yates drawn lazily: every step visits the moves in a fresh uniformly
+        // random order, but only shuffles as far as the first improving one
+        OpData selected_operation = OpData(OperationType::FORBIDDEN, 0, 0);
+        for (std::size_t i = 0; i < operations.size(); ++i)
         {
-            OpData op(operation);
-            int delta = op.evaluate(solution, nodes);
-
-            if (delta < 0)
+            std::swap(operations[i], operations[i + m_rng.below(operations.size() - i)]);
+            if (evaluate(operations[i]) < 0)
             {
-                selected_operation = op;
+                selected_operation = decodeMove(operations[i]);
+                if (selected_operation.m_type == OperationType::NODE_REPLACE)
+                {
+                    selected_operation.m_second_idx = state.outsideNodes()[selected_operation.m_second_idx];
+                }
                 break;
             }
         }
@@ -241,32 +609,67 @@ Solution GreedyImprover::improve(Solution &solution, const NodesDistPair &nodes)
         {
             break;
         }
-
-        updateOperationsVector(operations, solution, selected_operation);
-        selected_operation.apply(solution);
+        selected_operation.apply(state);
     }
-    return solution;
 }
 
 Solution SteepestImprover::improve(Solution &solution, const NodesDistPair &nodes)
 {
-    std::vector<int> operations = generateOperationsVector(solution, nodes);
-    OpData best_op = OpData(OperationType::FORBIDDEN, 0, 0);
+    TourState state(solution, nodes.nodes.size());
+    if (!m_full_scan)
+    {
+        MoveCache cache(state, nodes, m_ntype);
+        for (OpData op = cache.bestMove(state); !op.isInvalid(); op = cache.bestMove(state))
+        {
+            cache.apply(state, op);
+        }
+        solution = state.tour();
+        return solution;
+    }
 
+    // full scan row by row, split into chunks of rows that the pool scans in parallel
+    const int num_chunks = m_pool ? m_pool->size() * CHUNKS_PER_THREAD : 1;
+    std::vector<ScanBest> chunk_best(num_chunks * SCAN_PHASES);
+    std::vector<int> positions(state.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    Solution closed;
+    closed.reserve(state.size() + 1);
     while (true)
     {
-        int best_delta = 0;
-        best_op = OpData(OperationType::FORBIDDEN, 0, 0);
+        const Solution &tour = state.tour();
+        const int size = tour.size();
+        closed.assign(tour.begin(), tour.end());
+        closed.push_back(tour.front());
 
-        for (int operation : operations)
+        auto scan_chunk = [&](int chunk)
         {
-            OpData op(operation);
-            int delta = op.evaluate(solution, nodes);
+            int begin = static_cast<long long>(size) * chunk / num_chunks;
+            int end = static_cast<long long>(size) * (chunk + 1) / num_chunks;
+            scanRows(state, nodes, m_ntype, closed, positions, begin, end, &chunk_best[chunk * SCAN_PHASES]);
+        };
+        if (m_pool)
+        {
+            m_pool->run(num_chunks, scan_chunk);
+        }
+        else
+        {
+            scan_chunk(0);
+        }
 
-            if (delta < best_delta)
+        // the chunks hold consecutive rows, so keeping the first strictly better move
+        // phase by phase picks the same move as a single scan
+        int best_delta = 0;
+        OpData best_op = OpData(OperationType::FORBIDDEN, 0, 0);
+        for (int phase = 0; phase < SCAN_PHASES; ++phase)
+        {
+            for (int chunk = 0; chunk < num_chunks; ++chunk)
             {
-                best_delta = delta;
-                best_op = op;
+                const ScanBest &best = chunk_best[chunk * SCAN_PHASES + phase];
+                if (best.delta < best_delta)
+                {
+                    best_delta = best.delta;
+                    best_op = best.op;
+                }
             }
         }
 
@@ -274,242 +677,553 @@ Solution SteepestImprover::improve(Solution &solution, const NodesDistPair &node
         {
             break;
         }
-        updateOperationsVector(operations, solution, best_op);
-        best_op.apply(solution);
-        updateOperationsVectorPostApply(operations, solution, best_op);
+        best_op.apply(state);
     }
 
+    solution = state.tour();
     return solution;
 }
 
-const int UNVISITED = -1;
-
-std::vector<int> SteepestCandidateImprover::generateOperationsVector(const Solution &solution, const NodesDistPair &nodes)
+Solution SteepestCandidateImprover::improve(Solution &solution, const NodesDistPair &nodes)
 {
-    if (m_num_candidates > nodes.nodes.size() - 1)
+    if (m_ntype == NeighborhoodType::NODE)
     {
-        throw std::runtime_error("Too many candidates, max is " + std::to_string(nodes.nodes.size() - 1));
+        throw std::runtime_error("SteepestCandidateImprover does not support NODE neighborhood type");
     }
-    if (m_num_candidates < 1)
+
+    m_closest_nodes = getCandidateLists(nodes.nodes, m_num_candidates);
+    TourState state(solution, nodes.nodes.size());
+    if (fitsCompactOperation(state.size(), state.numNodes(), m_ntype))
     {
-        throw std::runtime_error("Too few candidates, min is 1");
+        descend<CompactOperation>(state, nodes);
     }
-    if (m_ntype == NeighborhoodType::NODE)
+    else
     {
-        throw std::runtime_error("SteepestCandidateImprover does not support NODE neighborhood type");
+        descend<Operation>(state, nodes);
     }
+    solution = state.tour();
+    return solution;
+}
 
-    m_closest_nodes = std::vector<std::vector<int>>(nodes.nodes.size(), std::vector<int>(m_num_candidates, 0));
-    for (int i = 0; i < nodes.nodes.size(); ++i)
+template <typename Word>
+void SteepestCandidateImprover::descend(TourState &state, const NodesDistPair &nodes)
+{
+    std::vector<Word> operations;
+    std::vector<int> ranks;
+    operations.reserve(includesOrOpt(m_ntype) ? m_num_candidates * state.size() * 10 : 0);
+    ranks.reserve(operations.capacity());
+    std::vector<int> candidate_positions;
+    std::vector<int> candidate_predecessors;
+    std::vector<int> inside_ranks;
+    std::vector<int> outside_candidates;
+    std::vector<int> outside_ranks;
+    candidate_positions.reserve(m_num_candidates);
+    candidate_predecessors.reserve(m_num_candidates);
+    inside_ranks.reserve(m_num_candidates);
+    outside_candidates.reserve(m_num_candidates);
+    outside_ranks.reserve(m_num_candidates);
+
+    while (true)
     {
-        std::vector<std::pair<int, int>> closest_nodes;
-        for (int j = 0; j < nodes.nodes.size(); ++j)
+        const Solution &tour = state.tour();
+        const int size = tour.size();
+        fillOperationsVector(operations, ranks, state);
+
+        // moves are evaluated in batches, so ties are broken by the rank of a move in
+        // the order of the sequential scan: by node, candidate and then the move itself
+        int best_delta = 0;
+        int best_rank = 0;
+        OpData best_op = OpData(OperationType::FORBIDDEN, 0, 0);
+        auto consider = [&](int delta, int rank, const OpData &op)
         {
-            if (i == j)
+            if (delta < best_delta || (delta < 0 && delta == best_delta && rank < best_rank))
             {
-                continue;
+                best_delta = delta;
+                best_rank = rank;
+                best_op = op;
+            }
+        };
+        auto consider_batch = [&](BatchMin batch, OperationType type, int first, const std::vector<int> &seconds,
+                                  const std::vector<int> &batch_ranks, int move)
+        {
+            if (batch.delta < 0)
+            {
+                consider(batch.delta, batch_ranks[batch.index] + move, OpData(type, first, seconds[batch.index]));
             }
-            // TODO: check if this is correct
-            closest_nodes.push_back(std::make_pair(nodes.dist[i][j] + nodes.nodes[j].getWeight(), j));
+        };
+
+        // edge swaps adding the edge from a node to its candidate, and replacements of
+        // its neighbours by candidates outside the tour
+        for (int i = 0; i < size; ++i)
+        {
+            candidate_positions.clear();
+            candidate_predecessors.clear();
+            inside_ranks.clear();
+            outside_candidates.clear();
+            outside_ranks.clear();
+            for (int j = 0; j < m_num_candidates; ++j)
+            {
+                int candidate = (*m_closest_nodes)[tour[i]][j];
+                int candidate_idx = state.position(candidate);
+                int rank = (i * m_num_candidates + j) * MOVES_PER_CANDIDATE;
+                if (candidate_idx == TourState::OUTSIDE)
+                {
+                    outside_candidates.push_back(candidate);
+                    outside_ranks.push_back(rank);
+                    continue;
+                }
+                candidate_positions.push_back(candidate_idx);
+                candidate_predecessors.push_back(candidate_idx == 0 ? size - 1 : candidate_idx - 1);
+                inside_ranks.push_back(rank);
+            }
+            int i_successor = (i + 1) % size;
+            int i_predecessor = (i - 1 + size) % size;
+            consider_batch(minEdgesSwapDelta(nodes, tour, i, candidate_positions.data(), candidate_positions.size()),
+                           OperationType::EDGE_SWAP, i, candidate_positions, inside_ranks, 0);
+            consider_batch(minEdgesSwapDelta(nodes, tour, i_predecessor, candidate_predecessors.data(), candidate_predecessors.size()),
+                           OperationType::EDGE_SWAP, i_predecessor, candidate_predecessors, inside_ranks, 1);
+            consider_batch(minReplaceNodeDelta(nodes, tour, i_successor, outside_candidates.data(), outside_candidates.size()),
+                           OperationType::NODE_REPLACE, i_successor, outside_candidates, outside_ranks, 0);
+            consider_batch(minReplaceNodeDelta(nodes, tour, i_predecessor, outside_candidates.data(), outside_candidates.size()),
+                           OperationType::NODE_REPLACE, i_predecessor, outside_candidates, outside_ranks, 1);
         }
-        std::sort(closest_nodes.begin(), closest_nodes.end());
-        for (int j = 0; j < m_num_candidates; ++j)
+
+        for (std::size_t k = 0; k < operations.size(); ++k)
         {
-            m_closest_nodes[i][j] = closest_nodes[j].second;
+            consider(evaluateMove<OperationType::OR_OPT>(operations[k], tour, nodes), ranks[k], decodeMove(operations[k]));
+        }
+
+        if (best_op.isInvalid())
+        {
+            break;
         }
+        best_op.apply(state);
     }
-    std::vector<int> node_solution_index(nodes.nodes.size(), UNVISITED);
-    for (int i = 0; i < solution.size(); ++i)
+}
+
+template <typename Word>
+void SteepestCandidateImprover::fillOperationsVector(std::vector<Word> &operations, std::vector<int> &ranks, const TourState &state) const
+{
+    operations.clear();
+    ranks.clear();
+    if (!includesOrOpt(m_ntype))
     {
-        node_solution_index[solution[i]] = i;
+        return;
     }
 
-    std::vector<int> operations = std::vector<int>(m_num_candidates * solution.size() * 2, 0);
+    const int size = state.size();
+    int rank = 0;
+    auto add_or_opt = [&](int first_idx, int length, int target_idx, bool reversed)
+    {
+        ++rank;
+        if (first_idx >= 0 && first_idx + length <= size && isOrOptTarget(size, first_idx, length, target_idx))
+        {
+            operations.push_back(encodeMove<Word>(OpData(OperationType::OR_OPT, first_idx, target_idx, length, reversed)));
+            ranks.push_back(rank);
+        }
+    };
 
-    int op_idx = -1;
-    for (int i = 0; i < solution.size(); ++i)
+    for (int i = 0; i < size; ++i)
     {
-        int i_successor = (i + 1) % solution.size();
-        int i_predecessor = (i - 1 + solution.size()) % solution.size();
         for (int j = 0; j < m_num_candidates; ++j)
         {
-            int candidate = m_closest_nodes[solution[i]][j];
-            int candidate_solution_index = node_solution_index[candidate];
-            if (candidate_solution_index == UNVISITED)
+            int candidate = (*m_closest_nodes)[state[i]][j];
+            int candidate_solution_index = state.position(candidate);
+            if (candidate_solution_index == TourState::OUTSIDE)
             {
-                operations[++op_idx] = OpData(OperationType::NODE_REPLACE, i_successor, candidate).toInt();
-                operations[++op_idx] = OpData(OperationType::NODE_REPLACE, i_predecessor, candidate).toInt();
+                continue;
             }
-            else
+
+            // segments starting or ending at the node, moved next to the candidate,
+            // ranked after the two edge swaps with the candidate
+            rank = (i * m_num_candidates + j) * MOVES_PER_CANDIDATE + 1;
+            int candidate_predecessor = (candidate_solution_index - 1 + size) % size;
+            add_or_opt(i, 1, candidate_solution_index, false);
+            add_or_opt(i, 1, candidate_predecessor, false);
+            for (int length = 2; length <= MAX_SEGMENT_LENGTH; ++length)
             {
-                int candidate_predecessor = (candidate_solution_index - 1 + solution.size()) % solution.size();
-                operations[++op_idx] = OpData(OperationType::EDGE_SWAP, i, candidate_solution_index).toInt();
-                operations[++op_idx] = OpData(OperationType::EDGE_SWAP, i_predecessor, candidate_predecessor).toInt();
+                add_or_opt(i, length, candidate_solution_index, false);
+                add_or_opt(i, length, candidate_predecessor, true);
+                add_or_opt(i - length + 1, length, candidate_solution_index, true);
+                add_or_opt(i - length + 1, length, candidate_predecessor, false);
             }
         }
     }
-
-    return operations;
 }
 
-void SteepestCandidateImprover::updateOperationsVector(std::vector<int> &operations, const Solution &solution, const OpData &op) const
+template <typename Tour>
+DontLookBitsImprover::Move DontLookBitsImprover::findImprovingMove(const Tour &tour, const NodesDistPair &nodes, int node) const
 {
-}
-
-void SteepestCandidateImprover::updateOperationsVectorPostApply(std::vector<int> &operations, const Solution &solution, const OpData &op) const
-{
-    std::vector<int> node_solution_index(200, UNVISITED);
-    for (int i = 0; i < solution.size(); ++i)
+    int succ = tour.next(node);
+    int pred = tour.prev(node);
+    int succ_next = tour.next(succ);
+    int pred_prev = tour.prev(pred);
+    const auto node_row = nodes.dist[node];
+
+    // what removing the successor or the predecessor of the node would save
+    int succ_removal = node_row[succ] + nodes.dist[succ][succ_next] + nodes.nodes[succ].getWeight();
+    int pred_removal = node_row[pred] + nodes.dist[pred][pred_prev] + nodes.nodes[pred].getWeight();
+
+    Move best_move{OperationType::FORBIDDEN, 0, 0};
+    int best_delta = 0;
+    auto consider = [&](OperationType type, int first, int second, int delta)
     {
-        node_solution_index[solution[i]] = i;
-    }
+        if (delta < best_delta)
+        {
+            best_delta = delta;
+            best_move = {type, first, second};
+        }
+    };
 
-    int op_idx = -1;
-    for (int i = 0; i < solution.size(); ++i)
+    for (int candidate : (*m_closest_nodes)[node])
     {
-        int i_successor = (i + 1) % solution.size();
-        int i_predecessor = (i - 1 + solution.size()) % solution.size();
-        for (int j = 0; j < m_num_candidates; ++j)
+        if (!tour.contains(candidate))
         {
-            int candidate = m_closest_nodes[solution[i]][j];
-            int candidate_solution_index = node_solution_index[candidate];
-            if (candidate_solution_index == UNVISITED)
+            // lists are ordered by distance plus weight, which bounds the insertion cost from below
+            int insertion = node_row[candidate] + nodes.nodes[candidate].getWeight();
+            if (insertion < succ_removal)
             {
-                operations[++op_idx] = OpData(OperationType::NODE_REPLACE, i_successor, candidate).toInt();
-                operations[++op_idx] = OpData(OperationType::NODE_REPLACE, i_predecessor, candidate).toInt();
+                consider(OperationType::NODE_REPLACE, succ, candidate, insertion + nodes.dist[candidate][succ_next] - succ_removal);
             }
-            else
+            if (insertion < pred_removal)
             {
-                int candidate_predecessor = (candidate_solution_index - 1 + solution.size()) % solution.size();
-                operations[++op_idx] = OpData(OperationType::EDGE_SWAP, i, candidate_solution_index).toInt();
-                operations[++op_idx] = OpData(OperationType::EDGE_SWAP, i_predecessor, candidate_predecessor).toInt();
+                consider(OperationType::NODE_REPLACE, pred, candidate, insertion + nodes.dist[candidate][pred_prev] - pred_removal);
             }
+            continue;
+        }
+
+        // a 2-opt move can only gain if the new edge is shorter than the one it replaces
+        int new_edge = node_row[candidate];
+        if (new_edge < node_row[succ])
+        {
+            int candidate_next = tour.next(candidate);
+            int delta = new_edge + nodes.dist[succ][candidate_next] - node_row[succ] - nodes.dist[candidate][candidate_next];
+            consider(OperationType::EDGE_SWAP, succ, candidate, delta);
+        }
+        if (new_edge < node_row[pred])
+        {
+            int candidate_prev = tour.prev(candidate);
+            int delta = new_edge + nodes.dist[pred][candidate_prev] - node_row[pred] - nodes.dist[candidate][candidate_prev];
+            consider(OperationType::EDGE_SWAP, node, candidate_prev, delta);
         }
     }
+    return best_move;
 }
 
-struct OperationDeltaPair
+template <typename Tour>
+void DontLookBitsImprover::descend(Tour &tour, const Solution &solution, const NodesDistPair &nodes) const
 {
-    int operation;
-    int delta;
-};
+    std::vector<bool> queued(nodes.nodes.size(), false);
+    std::queue<int> active;
 
-Solution SteepestSimplePrioritizingImprover::improve(Solution &solution, const NodesDistPair &nodes)
-{
-    auto cmp_op = [](const OperationDeltaPair o1, const OperationDeltaPair o2)
+    auto activate = [&](int node)
     {
-        return o1.delta > o2.delta;
+        if (!queued[node])
+        {
+            queued[node] = true;
+            active.push(node);
+        }
     };
 
-    std::priority_queue<OperationDeltaPair, std::vector<OperationDeltaPair>, decltype(cmp_op)> operations_queue(cmp_op);
-    std::vector<int> operations = generateOperationsVector(solution, nodes);
+    for (int node : solution)
+    {
+        activate(node);
+    }
 
-    for (int operation : operations)
+    while (!active.empty())
     {
-        int delta = OpData(operation).evaluate(solution, nodes);
-        if (delta >= 0)
+        int node = active.front();
+        active.pop();
+        queued[node] = false;
+        if (!tour.contains(node))
         {
             continue;
         }
-        operations_queue.push({operation, delta});
+
+        Move move = findImprovingMove(tour, nodes, node);
+        if (move.type == OperationType::FORBIDDEN)
+        {
+            continue;
+        }
+
+        int endpoints[4];
+        int num_endpoints = 0;
+        if (move.type == OperationType::NODE_REPLACE)
+        {
+            tour.replace(move.first, move.second);
+            endpoints[num_endpoints++] = move.second;
+        }
+        else
+        {
+            endpoints[num_endpoints++] = tour.prev(move.first);
+            endpoints[num_endpoints++] = move.first;
+            endpoints[num_endpoints++] = move.second;
+            endpoints[num_endpoints++] = tour.next(move.second);
+            tour.reversePath(move.first, move.second);
+        }
+
+        // replacement gains reach two edges away, so the neighbours of the endpoints are woken up as well
+        for (int i = 0; i < num_endpoints; ++i)
+        {
+            int endpoint = endpoints[i];
+            activate(endpoint);
+            int forward = endpoint;
+            int backward = endpoint;
+            for (int step = 0; step < 2; ++step)
+            {
+                forward = tour.next(forward);
+                backward = tour.prev(backward);
+                activate(forward);
+                activate(backward);
+            }
+        }
     }
+}
 
-    Solution prev_solution = solution;
+Solution DontLookBitsImprover::improve(Solution &solution, const NodesDistPair &nodes)
+{
+    m_closest_nodes = getCandidateLists(nodes.nodes, m_num_candidates);
+    if (static_cast<int>(solution.size()) >= m_two_level_size)
+    {
+        TwoLevelList tour(solution, nodes.nodes.size());
+        descend(tour, solution, nodes);
+        solution = tour.tour();
+    }
+    else
+    {
+        TourState tour(solution, nodes.nodes.size());
+        descend(tour, solution, nodes);
+        solution = tour.tour();
+    }
+    return solution;
+}
 
-    while (!operations_queue.empty())
+static bool containsEdge(const std::vector<std::pair<int, int>> &edges, int first, int second)
+{
+    for (const auto &edge : edges)
     {
-        OperationDeltaPair pair = operations_queue.top();
-        OpData op(pair.operation);
-        operations_queue.pop();
+        if ((edge.first == first && edge.second == second) || (edge.first == second && edge.second == first))
+        {
+            return true;
+        }
+    }
+    return false;
+}
 
-        if (!op.isApplicable(solution))
+void VariableDepthImprover::collectChainMoves(
+    const TourState &state,
+    const NodesDistPair &nodes,
+    int node,
+    int gain,
+    const Edges &added_edges,
+    std::vector<ChainMove> &moves) const
+{
+    const Solution &tour = state.tour();
+    const int size = state.size();
+    int idx = state.position(node);
+    int succ_idx = (idx + 1) % size;
+    int pred_idx = (idx - 1 + size) % size;
+    int succ = tour[succ_idx];
+    int pred = tour[pred_idx];
+    int succ_succ = tour[(succ_idx + 1) % size];
+    int pred_pred = tour[(pred_idx - 1 + size) % size];
+    const auto node_row = nodes.dist[node];
+
+    bool succ_free = !containsEdge(added_edges, node, succ);
+    bool pred_free = !containsEdge(added_edges, node, pred);
+    int succ_removal = node_row[succ] + nodes.dist[succ][succ_succ] + nodes.nodes[succ].getWeight();
+    int pred_removal = node_row[pred] + nodes.dist[pred][pred_pred] + nodes.nodes[pred].getWeight();
+
+    moves.clear();
+    for (int candidate : (*m_closest_nodes)[node])
+    {
+        int candidate_idx = state.position(candidate);
+        if (candidate_idx == TourState::OUTSIDE)
         {
+            // the removed node with its two edges against the candidate with the edge to the node
+            int insertion = node_row[candidate] + nodes.nodes[candidate].getWeight();
+            if (succ_free && gain + succ_removal - insertion > 0 && !containsEdge(added_edges, succ, succ_succ))
+            {
+                moves.push_back({OpData(OperationType::NODE_REPLACE, succ_idx, candidate),
+                                 getReplaceNodeDelta(nodes, tour, succ_idx, candidate), succ_removal - insertion});
+            }
+            if (pred_free && gain + pred_removal - insertion > 0 && !containsEdge(added_edges, pred, pred_pred))
+            {
+                moves.push_back({OpData(OperationType::NODE_REPLACE, pred_idx, candidate),
+                                 getReplaceNodeDelta(nodes, tour, pred_idx, candidate), pred_removal - insertion});
+            }
             continue;
         }
-        int new_delta = op.evaluate(solution, nodes);
-        if (new_delta >= 0 || new_delta != pair.delta)
+
+        // swaps with a tour neighbour do not change the tour
+        if (candidate == succ || candidate == pred)
         {
             continue;
         }
+        int new_edge = node_row[candidate];
+        int candidate_succ_idx = (candidate_idx + 1) % size;
+        int candidate_pred_idx = (candidate_idx - 1 + size) % size;
+        if (succ_free && gain + node_row[succ] - new_edge > 0 &&
+            !containsEdge(added_edges, candidate, tour[candidate_succ_idx]))
+        {
+            moves.push_back({OpData(OperationType::EDGE_SWAP, idx, candidate_idx),
+                             getEdgesSwapDelta(nodes, tour, idx, candidate_idx), node_row[succ] - new_edge});
+        }
+        if (pred_free && gain + node_row[pred] - new_edge > 0 &&
+            !containsEdge(added_edges, candidate, tour[candidate_pred_idx]))
+        {
+            moves.push_back({OpData(OperationType::EDGE_SWAP, pred_idx, candidate_pred_idx),
+                             getEdgesSwapDelta(nodes, tour, pred_idx, candidate_pred_idx), node_row[pred] - new_edge});
+        }
+    }
+}
 
-        prev_solution = solution;
-        op.apply(solution);
-
-        // readdding changed operations for reevaluation
-        std::vector<int> nodes_outside_solution = findMissingNumbers(solution, nodes.nodes.size());
+Solution VariableDepthImprover::improve(Solution &solution, const NodesDistPair &nodes)
+{
+    m_closest_nodes = getCandidateLists(nodes.nodes, m_num_candidates);
+    TourState state(solution, nodes.nodes.size());
+    std::vector<bool> queued(nodes.nodes.size(), false);
+    std::queue<int> active;
 
-        // find all node replacements that have to be reevaluated
-        for (int i = 0; i < solution.size(); i++)
+    auto activate = [&](int node)
+    {
+        if (!queued[node])
         {
-            int i_before = (i - 1 + solution.size()) % solution.size();
-            int i_after = (i + 1) % solution.size();
-            bool already_reevaluated = false;
+            queued[node] = true;
+            active.push(node);
+        }
+    };
 
-            // for node replacements, add replace operations for the replaced node
-            if (op.m_type == OperationType::NODE_REPLACE)
+    for (int node : solution)
+    {
+        activate(node);
+    }
+
+    Edges added_edges;
+    std::vector<OpData> undo_steps;
+    std::vector<int> touched;
+    std::vector<ChainMove> first_moves;
+    std::vector<ChainMove> moves;
+    auto by_delta = [](const ChainMove &m1, const ChainMove &m2)
+    {
+        return m1.delta < m2.delta;
+    };
+
+    // Applies the chain starting with the given move and keeps its most profitable prefix.
+    auto run_chain = [&](int node, ChainMove move)
+    {
+        added_edges.clear();
+        undo_steps.clear();
+        touched.clear();
+        // gain of the removed edges against the added ones, without the closing edge
+        int partial_gain = 0;
+        int gain = 0;
+        int best_gain = 0;
+        int best_length = 0;
+        std::size_t best_touched = 0;
+        int anchor = node;
+
+        for (int depth = 0; depth < m_max_depth; ++depth)
+        {
+            if (depth > 0)
             {
-                already_reevaluated = true;
-                OpData replace_op(OperationType::NODE_REPLACE, i, prev_solution[op.m_first_idx]);
-                int delta = replace_op.evaluate(solution, nodes);
-                if (delta < 0)
+                collectChainMoves(state, nodes, anchor, partial_gain, added_edges, moves);
+                if (moves.empty())
                 {
-                    operations_queue.push({replace_op.toInt(), delta});
+                    break;
                 }
+                move = *std::min_element(moves.begin(), moves.end(), by_delta);
             }
 
-            if (
-                solution[i] == prev_solution[i] &&
-                solution[i_before] == prev_solution[i_before] &&
-                solution[i_after] == prev_solution[i_after])
+            const OpData &op = move.op;
+            const int size = state.size();
+            if (op.m_type == OperationType::NODE_REPLACE)
             {
-                continue;
+                int prev = state[(op.m_first_idx - 1 + size) % size];
+                int next = state[(op.m_first_idx + 1) % size];
+                undo_steps.push_back(OpData(OperationType::NODE_REPLACE, op.m_first_idx, state[op.m_first_idx]));
+                added_edges.emplace_back(anchor, op.m_second_idx);
+                touched.insert(touched.end(), {prev, next, op.m_second_idx});
+                anchor = op.m_second_idx;
             }
-
-            for (int j = 0; j < nodes_outside_solution.size(); j++)
+            else
             {
-                if (already_reevaluated && nodes_outside_solution[j] == prev_solution[op.m_first_idx])
+                // reversing the same positions again restores the tour
+                int first = state[op.m_first_idx];
+                int first_next = state[(op.m_first_idx + 1) % size];
+                int second = state[op.m_second_idx];
+                int second_next = state[(op.m_second_idx + 1) % size];
+                undo_steps.push_back(op);
+                touched.insert(touched.end(), {first, first_next, second, second_next});
+                // the chain continues from the far end of the edge that closed the tour
+                if (anchor == first)
                 {
-                    continue;
+                    added_edges.emplace_back(first, second);
+                    anchor = second_next;
                 }
-                OpData replace_op(OperationType::NODE_REPLACE, i, nodes_outside_solution[j]);
-                int delta = replace_op.evaluate(solution, nodes);
-                if (delta < 0)
+                else
                 {
-                    operations_queue.push({replace_op.toInt(), delta});
+                    added_edges.emplace_back(first_next, second_next);
+                    anchor = second;
                 }
             }
+            op.apply(state);
+            partial_gain += move.gain;
+            gain -= move.delta;
+
+            if (gain > best_gain)
+            {
+                best_gain = gain;
+                best_length = undo_steps.size();
+                best_touched = touched.size();
+            }
         }
 
-        // find all edge swaps that have to be reevaluated
-        for (int i = 0; i < solution.size(); ++i)
+        while (undo_steps.size() > best_length)
         {
-            int i_successor = (i + 1) % solution.size();
-            for (int j = i + 2; j < solution.size(); ++j)
+            undo_steps.back().apply(state);
+            undo_steps.pop_back();
+        }
+        // replacement gains reach two edges away, so the tour neighbours are woken up as well
+        const int size = state.size();
+        for (std::size_t i = 0; i < best_touched; ++i)
+        {
+            int idx = state.position(touched[i]);
+            if (idx == TourState::OUTSIDE)
             {
-                if (i == 0 && j == solution.size() - 1)
-                {
-                    continue;
-                }
-                int j_successor = (j + 1) % solution.size();
+                continue;
+            }
+            activate(state[(idx - 1 + size) % size]);
+            activate(touched[i]);
+            activate(state[(idx + 1) % size]);
+        }
+        return best_gain > 0;
+    };
 
-                if (
-                    solution[i] == prev_solution[i] &&
-                    solution[j] == prev_solution[j] &&
-                    solution[i_successor] == prev_solution[i_successor] &&
-                    solution[j_successor] == prev_solution[j_successor])
-                {
-                    continue;
-                }
+    while (!active.empty())
+    {
+        int node = active.front();
+        active.pop();
+        queued[node] = false;
+        if (!state.contains(node))
+        {
+            continue;
+        }
 
-                OpData edge_swap_op(OperationType::EDGE_SWAP, i, j);
-                int delta = edge_swap_op.evaluate(solution, nodes);
-                if (delta < 0)
-                {
-                    operations_queue.push({edge_swap_op.toInt(), delta});
-                }
+        // the first step backtracks over the best few alternatives
+        added_edges.clear();
+        collectChainMoves(state, nodes, node, 0, added_edges, first_moves);
+        std::sort(first_moves.begin(), first_moves.end(), by_delta);
+        for (int i = 0; i < first_moves.size() && i < m_breadth; ++i)
+        {
+            if (run_chain(node, first_moves[i]))
+            {
+                break;
             }
         }
     }
+
+    solution = state.tour();
     return solution;
 }
 
@@ -527,34 +1241,61 @@ NeighborhoodType getNeighborhoodType(const std::string &ntype)
     {
         return NeighborhoodType::BOTH;
     }
+    else if (ntype == "or")
+    {
+        return NeighborhoodType::OR_OPT;
+    }
     else
     {
         throw std::runtime_error("Invalid neighborhood type");
     }
 }
 
-Solution MultipleStartImprover::randomizeSolution(const NodesDistPair &nodes, int seed_idx, int target_size) const
+Solution MultipleStartImprover::randomizeSolution(const NodesDistPair &nodes, Rng &rng, int target_size) const
 {
-    m_rng.seed(m_seed + seed_idx * SEED_SPREAD);
-    Solution solution = shuffledIndices(nodes.nodes.size(), m_rng);
+    Solution solution = shuffledIndices(nodes.nodes.size(), rng);
     solution.resize(target_size);
     return solution;
 }
 
 Solution MultipleStartImprover::improve(Solution &solution, const NodesDistPair &nodes)
 {
+    std::vector<Solution> solutions(m_repeats);
+    std::vector<int> scores(m_repeats);
+    Rng seeded(m_seed);
+    std::vector<Rng> streams;
+    for (int i = 0; i < m_repeats; ++i)
+    {
+        streams.push_back(seeded.split());
+    }
+    auto restart = [&](int i)
+    {
+        Solution random_solution = randomizeSolution(nodes, streams[i], solution.size());
+        auto improver = createImprover(m_improver_type, m_ntype, m_param, streams[i]);
+        solutions[i] = improver->improve(random_solution, nodes);
+        scores[i] = evaluateSolution(nodes.nodes, solutions[i]);
+    };
+    if (m_pool)
+    {
+        m_pool->run(m_repeats, restart);
+    }
+    else
+    {
+        for (int i = 0; i < m_repeats; ++i)
+        {
+            restart(i);
+        }
+    }
+
+    // the first of the best restarts wins, as in a sequential run
     Solution best_solution;
     int best_score = std::numeric_limits<int>::max();
     for (int i = 0; i < m_repeats; ++i)
     {
-        Solution random_solution = randomizeSolution(nodes, i, solution.size());
-        auto improver = createImprover(m_improver_type, m_ntype, m_param);
-        Solution solution = improver->improve(random_solution, nodes);
-        int score = evaluateSolution(nodes.nodes, solution);
-        if (score < best_score)
+        if (scores[i] < best_score)
         {
-            best_score = score;
-            best_solution = solution;
+            best_score = scores[i];
+            best_solution = std::move(solutions[i]);
         }
     }
     return best_solution;
@@ -568,18 +1309,20 @@ std::string IteratedImprover::additionalInfo() const
 Solution IteratedImprover::peturb(Solution &solution, const NodesDistPair &nodes)
 {
 
+    TourState state(solution, nodes.nodes.size());
+    const std::vector<int> &nodes_outside_solution = state.outsideNodes();
     for (int i = 0; i < m_perturb_size; ++i)
     {
-        if (m_rng() % 2 == 0)
+        if (m_rng.below(2) == 0)
         {
-            auto nodesOutSolution = findMissingNumbers(solution, nodes.nodes.size());
-            solution = replaceNode(solution, m_rng() % solution.size(), nodesOutSolution[m_rng() % nodesOutSolution.size()]);
+            state.replaceNode(m_rng.below(state.size()), nodes_outside_solution[m_rng.below(nodes_outside_solution.size())]);
         }
         else
         {
-            solution = swapEdges(solution, m_rng() % solution.size(), m_rng() % solution.size());
+            state.swapEdges(m_rng.below(state.size()), m_rng.below(state.size()));
         }
     }
+    solution = state.tour();
     return solution;
 }
 
@@ -592,7 +1335,7 @@ Solution IteratedImprover::improve(Solution &solution, const NodesDistPair &node
     while (true)
     {
         Solution peturbed_solution = peturb(solution, nodes);
-        auto improver = createImprover(m_improver_type, m_ntype, m_param);
+        auto improver = createImprover(m_improver_type, m_ntype, m_param, m_rng);
         peturbed_solution = improver->improve(peturbed_solution, nodes);
         int score = evaluateSolution(nodes.nodes, peturbed_solution);
         if (score < best_score)
@@ -628,10 +1371,11 @@ Solution LargeNeighborhoodImprover::disrupt(Solution &solution, const NodesDistP
         costs[i] += nodes.dist[solution[i]][solution[index_after]];
     }
 
-    std::vector<int> to_remove = sampleWeightedWithoutReplacement(costs, m_disrupt_size, m_rng);
+    m_sampler.assign(costs);
+    m_sampler.sampleWithoutReplacement(m_disrupt_size, m_rng, m_to_remove);
     Solution disrupted_solution;
     std::vector<bool> to_remove_bool(solution.size(), false);
-    for (int i : to_remove)
+    for (int i : m_to_remove)
     {
         to_remove_bool[i] = true;
     }
@@ -650,7 +1394,7 @@ Solution LargeNeighborhoodImprover::repair(Solution &solution, const NodesDistPa
 {
     auto solver = GreedyCycleSolver();
     solver.setStartingSolution(solution);
-    return solver.solve(nodes.nodes, 0, nodes.nodes.size() / 2);
+    return solver.solve(nodes, 0, nodes.nodes.size() / 2);
 }
 
 Solution LargeNeighborhoodImprover::improve(Solution &solution, const NodesDistPair &nodes)
@@ -668,7 +1412,7 @@ Solution LargeNeighborhoodImprover::improve(Solution &solution, const NodesDistP
         int original_score = evaluateSolution(nodes.nodes, solution);
         if (m_improver_type != 'o')
         {
-            auto improver = createImprover(m_improver_type, m_ntype, m_param);
+            auto improver = createImprover(m_improver_type, m_ntype, m_param, m_rng);
             Solution improved_solution = improver->improve(repaired_solution, nodes);
             int old_repaired_score = repaired_score;
             repaired_score = evaluateSolution(nodes.nodes, improved_solution);
@@ -707,52 +1451,160 @@ std::string LargeNeighborhoodImprover::additionalInfo() const
 Solution GeneticLocalSearchImprover::improve(Solution &solution, const NodesDistPair &nodes)
 {
     int initial_cost = evaluateSolution(nodes.nodes, solution);
-    m_rng.seed(initial_cost);
+    if (m_num_islands > 1)
+    {
+        return improveIslands(nodes, initial_cost);
+    }
+    // seeded from the instance, so the same start tour evolves the same way
+    Rng rng(initial_cost);
 
     const auto start = std::chrono::high_resolution_clock::now();
-    Population population = initializePopulation(nodes);
+    Population population = initializePopulation(nodes, rng);
     m_iterations = 0;
     while (true)
     {
         m_iterations++;
-        bool in_population = false;
-        std::vector<int> indices = shuffledIndices(population.size(), m_rng);
-        int index_1 = indices[0];
-        int index_2 = indices[1];
-        Solution child = recombine(population[index_1].solution, population[index_2].solution, nodes.nodes);
-        if (m_improver_type != 'o')
+        evolve(population, nodes, rng);
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        if (elapsed.count() > m_time_limit)
         {
-            auto improver = createImprover(m_improver_type, m_ntype, m_param);
-            Solution improved = improver->improve(child, nodes);
-            child = improved;
+            break;
         }
+    }
+
+    return population.front().solution;
+}
 
-        int cost = evaluateSolution(nodes.nodes, child);
+void GeneticLocalSearchImprover::evolve(Population &population, const NodesDistPair &nodes, Rng &rng)
+{
+    std::vector<int> indices = shuffledIndices(population.size(), rng);
+    int index_1 = indices[0];
+    int index_2 = indices[1];
+    Solution child = recombine(population[index_1].solution, population[index_2].solution, nodes, rng);
+    if (m_improver_type != 'o')
+    {
+        auto improver = createImprover(m_improver_type, m_ntype, m_param, rng);
+        Solution improved = improver->improve(child, nodes);
+        child = improved;
+    }
 
-        for (auto instance : population)
+    int cost = evaluateSolution(nodes.nodes, child);
+    tryInsert(population, {child, cost});
+}
+
+bool GeneticLocalSearchImprover::tryInsert(Population &population, const EvaluatedSolution &candidate)
+{
+    for (auto &instance : population)
+    {
+        if (instance.cost == candidate.cost)
         {
-            if (instance.cost == cost)
+            return false;
+        }
+    }
+
+    if (candidate.cost >= population.back().cost)
+    {
+        return false;
+    }
+    population.back() = candidate;
+    std::sort(population.begin(), population.end());
+    return true;
+}
+
+Solution GeneticLocalSearchImprover::improveIslands(const NodesDistPair &nodes, int initial_cost)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // every island draws from its own stream split off one seeded from the initial cost
+    Rng seeded(initial_cost);
+    std::vector<Rng> streams;
+    for (int island = 0; island < m_num_islands; ++island)
+    {
+        streams.push_back(seeded.split());
+    }
+
+    // island i sends to mailboxes[(i + 1) % m_num_islands] and reads mailboxes[i]
+    std::vector<std::unique_ptr<SpscQueue<EvaluatedSolution>>> mailboxes;
+    for (int island = 0; island < m_num_islands; ++island)
+    {
+        mailboxes.push_back(std::make_unique<SpscQueue<EvaluatedSolution>>(MAILBOX_CAPACITY));
+    }
+    std::vector<int> iterations(m_num_islands, 0);
+    std::vector<std::exception_ptr> errors(m_num_islands);
+
+    // every island keeps its own best, which is only read once all islands have stopped
+    std::vector<EvaluatedSolution> island_best(m_num_islands, {Solution(), INT_MAX});
+
+    auto run_island = [&](int island)
+    {
+        try
+        {
+            Rng &rng = streams[island];
+            Population population = initializePopulation(nodes, rng);
+            SpscQueue<EvaluatedSolution> &inbox = *mailboxes[island];
+            SpscQueue<EvaluatedSolution> &outbox = *mailboxes[(island + 1) % m_num_islands];
+            EvaluatedSolution migrant;
+            auto keep_best = [&]()
             {
-                in_population = true;
-                break;
+                if (population.front().cost < island_best[island].cost)
+                {
+                    island_best[island] = population.front();
+                }
+            };
+
+            keep_best();
+            while (true)
+            {
+                ++iterations[island];
+                evolve(population, nodes, rng);
+                while (inbox.tryPop(migrant))
+                {
+                    tryInsert(population, migrant);
+                }
+                keep_best();
+                // a full mailbox means the next island is behind, so the migrant is dropped
+                if (iterations[island] % m_migration_interval == 0)
+                {
+                    outbox.tryPush(population.front());
+                }
+
+                const auto end = std::chrono::high_resolution_clock::now();
+                const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+                if (elapsed.count() > m_time_limit)
+                {
+                    break;
+                }
             }
         }
-
-        if ((cost < population.back().cost) && !in_population)
+        catch (...)
         {
-            population.back() = {child, cost};
-            std::sort(population.begin(), population.end());
+            errors[island] = std::current_exception();
         }
+    };
 
-        const auto end = std::chrono::high_resolution_clock::now();
-        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        if (elapsed.count() > m_time_limit)
+    std::vector<std::thread> threads;
+    for (int island = 1; island < m_num_islands; ++island)
+    {
+        threads.emplace_back(run_island, island);
+    }
+    run_island(0);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error)
         {
-            break;
+            std::rethrow_exception(error);
         }
     }
-
-    return population.front().solution;
+    Solution result = std::min_element(island_best.begin(), island_best.end())->solution;
+    m_iterations = std::accumulate(iterations.begin(), iterations.end(), 0);
+    return result;
 }
 
 std::string GeneticLocalSearchImprover::additionalInfo() const
@@ -835,7 +1687,7 @@ Segments parseEdgesToSegments(Edges &edges)
     return segments;
 }
 
-Solution GeneticLocalSearchImprover::recombine(Solution &s1, Solution &s2, const Nodes &nodes) const noexcept
+Solution GeneticLocalSearchImprover::recombine(Solution &s1, Solution &s2, const NodesDistPair &nodes, Rng &rng) const
 {
     Edges common_edges;
     Edges s1_edges;
@@ -867,7 +1719,7 @@ Solution GeneticLocalSearchImprover::recombine(Solution &s1, Solution &s2, const
 
     Segments segments = parseEdgesToSegments(common_edges);
 
-    std::shuffle(segments.begin(), segments.end(), m_rng);
+    std::shuffle(segments.begin(), segments.end(), rng);
     std::vector<int> child = segments[0];
     for (int i = 1; i < segments.size(); ++i)
     {
@@ -879,12 +1731,12 @@ Solution GeneticLocalSearchImprover::recombine(Solution &s1, Solution &s2, const
     return solver.solve(nodes, 0, s1.size());
 }
 
-GeneticLocalSearchImprover::Population GeneticLocalSearchImprover::initializePopulation(const NodesDistPair &nodes) noexcept
+GeneticLocalSearchImprover::Population GeneticLocalSearchImprover::initializePopulation(const NodesDistPair &nodes, Rng &rng)
 {
     GeneticLocalSearchImprover::Population population;
     while (population.size() < m_elite_size)
     {
-        Solution instance = shuffledIndices(nodes.nodes.size(), m_rng);
+        Solution instance = shuffledIndices(nodes.nodes.size(), rng);
         instance.resize(nodes.nodes.size() / 2);
         auto improver = SteepestSimplePrioritizingImprover(NeighborhoodType::EDGE);
         auto improved = improver.improve(instance, nodes);
@@ -912,15 +1764,15 @@ GeneticLocalSearchImprover::Population GeneticLocalSearchImprover::initializePop
 }
 
 Solution
-AlternativeGeneticLocalSearchImprover::recombine(Solution &s1, Solution &s2, const Nodes &nodes) const noexcept
+AlternativeGeneticLocalSearchImprover::recombine(Solution &s1, Solution &s2, const NodesDistPair &nodes, Rng &) const
 {
     Solution child;
-    std::vector<bool> used(nodes.size(), false);
+    std::vector<bool> used(nodes.nodes.size(), false);
 
     for (int i = 0; i < s1.size(); ++i)
     {
         auto selected = s1[i];
-        if (nodes[selected].getWeight() > nodes[s2[i]].getWeight())
+        if (nodes.nodes[selected].getWeight() > nodes.nodes[s2[i]].getWeight())
         {
             selected = s2[i];
         }
@@ -939,31 +1791,52 @@ std::unique_ptr<AbstractImprover> createImprover(
     char name,
     NeighborhoodType ntype,
     int param,
+    Rng &rng,
     char subname,
     double subparam_1,
-    int subparam_2)
+    int subparam_2,
+    int num_threads)
 {
     switch (name)
     {
     case 'g':
-        return std::make_unique<GreedyImprover>(ntype);
+        return std::make_unique<GreedyImprover>(ntype, rng);
     case 's':
-        return std::make_unique<SteepestImprover>(ntype);
+        return std::make_unique<SteepestImprover>(ntype, num_threads);
     case 'c':
         return std::make_unique<SteepestCandidateImprover>(ntype, param);
     case 'p':
         return std::make_unique<SteepestSimplePrioritizingImprover>(ntype);
+    case 'b':
+        return std::make_unique<DontLookBitsImprover>(ntype, param);
+    case 'v':
+        return std::make_unique<VariableDepthImprover>(ntype, param);
     case 'm':
-        return std::make_unique<MultipleStartImprover>(ntype, subname, param, subparam_1, subparam_2);
+        return std::make_unique<MultipleStartImprover>(ntype, subname, param, rng, subparam_1, subparam_2, num_threads);
     case 'i':
-        return std::make_unique<IteratedImprover>(ntype, subname, param, subparam_1, subparam_2);
+        return std::make_unique<IteratedImprover>(ntype, subname, param, rng, subparam_1, subparam_2);
     case 'l':
-        return std::make_unique<LargeNeighborhoodImprover>(ntype, subname, param, subparam_1, subparam_2);
+        return std::make_unique<LargeNeighborhoodImprover>(ntype, subname, param, rng, subparam_1, subparam_2);
     case 'e':
-        return std::make_unique<GeneticLocalSearchImprover>(ntype, subname, param, subparam_1, subparam_2);
+        return std::make_unique<GeneticLocalSearchImprover>(ntype, subname, param, rng, subparam_1, subparam_2, num_threads);
     case 'a':
-        return std::make_unique<AlternativeGeneticLocalSearchImprover>(ntype, subname, param, subparam_1, subparam_2);
+        return std::make_unique<AlternativeGeneticLocalSearchImprover>(ntype, subname, param, rng, subparam_1, subparam_2, num_threads);
     default:
         throw std::runtime_error("Invalid improver name");
     }
+}
+
+bool improverUsesThreads(char name, NeighborhoodType ntype)
+{
+    switch (name)
+    {
+    case 's':
+        return includesOrOpt(ntype);
+    case 'm':
+    case 'e':
+    case 'a':
+        return true;
+    default:
+        return false;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,382 @@
+#include "move_cache.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <tuple>
+
+MoveCache::MoveCache(const TourState &state, const NodesDistPair &nodes, NeighborhoodType type)
+    : m_nodes(nodes),
+      m_num_nodes(state.numNodes()),
+      m_node_swaps(includesNodeSwaps(type)),
+      m_edge_swaps(includesEdgeSwaps(type)),
+      m_stamp(state.numNodes(), 0),
+      m_best_replacement(state.numNodes(), NO_REPLACEMENT)
+{
+    Key squared = static_cast<Key>(m_num_nodes) * m_num_nodes;
+    m_swap_base = m_edge_swaps ? 4 * squared : 0;
+    m_replace_base = m_swap_base + (m_node_swaps ? squared : 0);
+    // room for the keys a move can add: each of at most six touched nodes is paired
+    // with every tour node, plus a replacement per tour node
+    constexpr int KEYS_PER_PAIR = 5;
+    const int tour_size = state.size();
+    const int keys_per_move = (6 * KEYS_PER_PAIR + 1) * tour_size;
+    m_heap.reserve(keys_per_move);
+    m_parked.reserve(tour_size + 16);
+    m_ties.reserve(tour_size + 16);
+
+    m_outside_by_weight.reserve(m_num_nodes);
+    m_outside_by_weight = state.outsideNodes();
+    std::sort(m_outside_by_weight.begin(), m_outside_by_weight.end(), [this](int first, int second)
+              { return lighter(first, second); });
+
+    const Solution &tour = state.tour();
+    for (int i = 0; i < tour_size; ++i)
+    {
+        for (int j = i + 1; j < tour_size; ++j)
+        {
+            evaluatePair(state, tour[i], tour[j]);
+        }
+        evaluateReplacements(state, tour[i]);
+    }
+    m_heap.reserve(m_heap.size() + keys_per_move);
+}
+
+bool MoveCache::lighter(int first, int second) const
+{
+    const std::vector<int> &weights = m_nodes.weights;
+    return weights[first] < weights[second] || (weights[first] == weights[second] && first < second);
+}
+
+MoveCache::Key MoveCache::edgeSwapKey(int first, int second, int first_slot, int second_slot) const
+{
+    return (static_cast<Key>(first) * m_num_nodes + second) * 4 + first_slot * 2 + second_slot;
+}
+
+void MoveCache::update(Key key, int delta)
+{
+    if (delta < 0)
+    {
+        m_heap.update(key, delta);
+    }
+    else
+    {
+        m_heap.erase(key);
+    }
+}
+
+void MoveCache::evaluatePair(const TourState &state, int first, int second)
+{
+    if (first > second)
+    {
+        std::swap(first, second);
+    }
+    const auto &dist = m_nodes.dist;
+    int first_prev = state.prev(first);
+    int first_next = state.next(first);
+    int second_prev = state.prev(second);
+    int second_next = state.next(second);
+
+    if (m_node_swaps)
+    {
+        int delta;
+        if (first_next == second)
+        {
+            delta = dist[first_prev][second] + dist[first][second_next] - dist[first_prev][first] - dist[second][second_next];
+        }
+        else if (second_next == first)
+        {
+            delta = dist[second_prev][first] + dist[second][first_next] - dist[second_prev][second] - dist[first][first_next];
+        }
+        else
+        {
+            delta = dist[first_prev][second] + dist[first_next][second] + dist[second_prev][first] + dist[second_next][first] -
+                    dist[first_prev][first] - dist[first_next][first] - dist[second_prev][second] - dist[second_next][second];
+        }
+        update(m_swap_base + static_cast<Key>(first) * m_num_nodes + second, delta);
+    }
+
+    if (m_edge_swaps)
+    {
+        // neighbours are numbered by id, which a reversal does not change. A 2-opt move
+        // is found from both pairs of endpoints it joins, and only kept under the pair
+        // holding the smallest of its four nodes.
+        const int first_neighbors[] = {std::min(first_prev, first_next), std::max(first_prev, first_next)};
+        const int second_neighbors[] = {std::min(second_prev, second_next), std::max(second_prev, second_next)};
+        const auto first_row = dist[first];
+        for (int first_slot = 0; first_slot < 2; ++first_slot)
+        {
+            for (int second_slot = 0; second_slot < 2; ++second_slot)
+            {
+                int first_neighbor = first_neighbors[first_slot];
+                int second_neighbor = second_neighbors[second_slot];
+                int delta = 0;
+                if (first_neighbor != second_neighbor && first_neighbor != second && second_neighbor != first &&
+                    std::min(first_neighbor, second_neighbor) > first)
+                {
+                    delta = first_row[second] + dist[first_neighbor][second_neighbor] -
+                            first_row[first_neighbor] - dist[second][second_neighbor];
+                }
+                update(edgeSwapKey(first, second, first_slot, second_slot), delta);
+            }
+        }
+    }
+}
+
+void MoveCache::evaluateReplacements(const TourState &state, int tour_node)
+{
+    const std::vector<int> &weights = m_nodes.weights;
+    const auto prev_row = m_nodes.dist[state.prev(tour_node)];
+    const auto next_row = m_nodes.dist[state.next(tour_node)];
+
+    // with distances rounded to integers, the two edges through a replacement are at
+    // most one shorter than the edge it replaces, which bounds the cost of every
+    // heavier node once one has been found
+    int detour_bound = prev_row[state.next(tour_node)] - 1;
+    int best = NO_REPLACEMENT;
+    int best_cost = INT_MAX;
+    for (int outside_node : m_outside_by_weight)
+    {
+        if (weights[outside_node] + detour_bound > best_cost)
+        {
+            break;
+        }
+        int cost = prev_row[outside_node] + next_row[outside_node] + weights[outside_node];
+        if (cost < best_cost || (cost == best_cost && state.outsideSlot(outside_node) < state.outsideSlot(best)))
+        {
+            best = outside_node;
+            best_cost = cost;
+        }
+    }
+
+    m_best_replacement[tour_node] = best;
+    if (best == NO_REPLACEMENT)
+    {
+        m_heap.erase(m_replace_base + tour_node);
+        return;
+    }
+    int removal_gain = prev_row[tour_node] + next_row[tour_node] + weights[tour_node];
+    update(m_replace_base + tour_node, best_cost - removal_gain);
+}
+
+void MoveCache::offerReplacement(const TourState &state, int tour_node, int outside_node)
+{
+    int best = m_best_replacement[tour_node];
+    if (best == NO_REPLACEMENT)
+    {
+        evaluateReplacements(state, tour_node);
+        return;
+    }
+    const std::vector<int> &weights = m_nodes.weights;
+    const auto prev_row = m_nodes.dist[state.prev(tour_node)];
+    const auto next_row = m_nodes.dist[state.next(tour_node)];
+    int cost = prev_row[outside_node] + next_row[outside_node] + weights[outside_node];
+    int best_cost = prev_row[best] + next_row[best] + weights[best];
+    if (cost < best_cost || (cost == best_cost && state.outsideSlot(outside_node) < state.outsideSlot(best)))
+    {
+        m_best_replacement[tour_node] = outside_node;
+        int removal_gain = prev_row[tour_node] + next_row[tour_node] + weights[tour_node];
+        update(m_replace_base + tour_node, cost - removal_gain);
+    }
+}
+
+void MoveCache::eraseMovesOf(int node)
+{
+    // swaps with the node are dropped lazily by bestMove, and all of them are
+    // evaluated again if it comes back into the tour
+    m_heap.erase(m_replace_base + node);
+    m_best_replacement[node] = NO_REPLACEMENT;
+}
+
+OpData MoveCache::moveOf(const TourState &state, Key key, int delta)
+{
+    if (key >= m_replace_base)
+    {
+        int tour_node = key - m_replace_base;
+        return OpData(OperationType::NODE_REPLACE, state.position(tour_node), m_best_replacement[tour_node]);
+    }
+    if (key >= m_swap_base)
+    {
+        int first = (key - m_swap_base) / m_num_nodes;
+        int second = (key - m_swap_base) % m_num_nodes;
+        if (state.contains(first) && state.contains(second))
+        {
+            return OpData(OperationType::NODE_SWAP, state.position(first), state.position(second));
+        }
+        return OpData(OperationType::FORBIDDEN, 0, 0);
+    }
+
+    int first = key / 4 / m_num_nodes;
+    int second = key / 4 % m_num_nodes;
+    if (!state.contains(first) || !state.contains(second))
+    {
+        return OpData(OperationType::FORBIDDEN, 0, 0);
+    }
+    int first_prev = state.prev(first);
+    int first_next = state.next(first);
+    int second_prev = state.prev(second);
+    int second_next = state.next(second);
+    int first_neighbor = key & 2 ? std::max(first_prev, first_next) : std::min(first_prev, first_next);
+    int second_neighbor = key & 1 ? std::max(second_prev, second_next) : std::min(second_prev, second_next);
+
+    // an edge swap exists only while both removed edges point the same way
+    if (first_next == first_neighbor && second_next == second_neighbor)
+    {
+        return OpData(OperationType::EDGE_SWAP, state.position(first), state.position(second));
+    }
+    if (first_prev == first_neighbor && second_prev == second_neighbor)
+    {
+        return OpData(OperationType::EDGE_SWAP, state.position(first_neighbor), state.position(second_neighbor));
+    }
+    m_parked.push_back({key, delta, m_stamp[first], m_stamp[second]});
+    return OpData(OperationType::FORBIDDEN, 0, 0);
+}
+
+// Position of a move in the order of the full scan: node swaps, edge swaps and then
+// replacements, each by the first position and then by the second position or the
+// outside slot of the inserted node.
+static std::tuple<OperationType, int, int> scanOrder(const TourState &state, const OpData &op)
+{
+    if (op.m_type == OperationType::NODE_REPLACE)
+    {
+        return {op.m_type, op.m_first_idx, state.outsideSlot(op.m_second_idx)};
+    }
+    return {op.m_type, std::min(op.m_first_idx, op.m_second_idx), std::max(op.m_first_idx, op.m_second_idx)};
+}
+
+OpData MoveCache::bestMove(const TourState &state)
+{
+    for (const Parked &parked : m_parked)
+    {
+        int first = parked.key / 4 / m_num_nodes;
+        int second = parked.key / 4 % m_num_nodes;
+        if (m_stamp[first] == parked.first_stamp && m_stamp[second] == parked.second_stamp)
+        {
+            m_heap.update(parked.key, parked.delta);
+        }
+    }
+    m_parked.clear();
+
+    // all valid moves of the best delta are taken out, so that ties go to the move the
+    // full scan would find first, and put back afterwards
+    m_ties.clear();
+    while (!m_heap.empty() && (m_ties.empty() || m_heap.topPriority() == m_ties.front().delta))
+    {
+        Key key = m_heap.top();
+        int delta = m_heap.topPriority();
+        OpData op = moveOf(state, key, delta);
+        m_heap.pop();
+        if (!op.isInvalid())
+        {
+            m_ties.push_back({key, delta, op});
+        }
+    }
+
+    OpData best = OpData(OperationType::FORBIDDEN, 0, 0);
+    for (const Tie &tie : m_ties)
+    {
+        if (best.isInvalid() || scanOrder(state, tie.op) < scanOrder(state, best))
+        {
+            best = tie.op;
+        }
+        m_heap.update(tie.key, tie.delta);
+    }
+    return best;
+}
+
+void MoveCache::apply(TourState &state, const OpData &op)
+{
+    const int size = state.size();
+    auto at = [&](int idx)
+    { return state[(idx % size + size) % size]; };
+
+    // nodes whose tour neighbours change
+    int touched[6];
+    int num_touched = 0;
+    auto touch = [&](int node)
+    {
+        if (std::find(touched, touched + num_touched, node) == touched + num_touched)
+        {
+            touched[num_touched++] = node;
+        }
+    };
+    switch (op.m_type)
+    {
+    case OperationType::EDGE_SWAP:
+        touch(at(op.m_first_idx));
+        touch(at(op.m_first_idx + 1));
+        touch(at(op.m_second_idx));
+        touch(at(op.m_second_idx + 1));
+        break;
+    case OperationType::NODE_SWAP:
+        for (int idx : {op.m_first_idx, op.m_second_idx})
+        {
+            touch(at(idx));
+            touch(at(idx - 1));
+            touch(at(idx + 1));
+        }
+        break;
+    default:
+        touch(at(op.m_first_idx));
+        touch(at(op.m_first_idx - 1));
+        touch(at(op.m_first_idx + 1));
+        touch(op.m_second_idx);
+        break;
+    }
+
+    int removed = op.m_type == OperationType::NODE_REPLACE ? at(op.m_first_idx) : NO_REPLACEMENT;
+    op.apply(state);
+    for (int i = 0; i < num_touched; ++i)
+    {
+        ++m_stamp[touched[i]];
+    }
+    if (removed != NO_REPLACEMENT)
+    {
+        auto by_weight = [this](int first, int second)
+        { return lighter(first, second); };
+        int inserted = op.m_second_idx;
+        m_outside_by_weight.erase(std::lower_bound(m_outside_by_weight.begin(), m_outside_by_weight.end(), inserted, by_weight));
+        m_outside_by_weight.insert(std::lower_bound(m_outside_by_weight.begin(), m_outside_by_weight.end(), removed, by_weight), removed);
+    }
+
+    auto is_touched = [&](int node)
+    { return std::find(touched, touched + num_touched, node) != touched + num_touched; };
+    for (int i = 0; i < num_touched; ++i)
+    {
+        int node = touched[i];
+        if (!state.contains(node))
+        {
+            eraseMovesOf(node);
+            continue;
+        }
+        // pairs of touched nodes are evaluated once, from the smaller one
+        for (int other : state.tour())
+        {
+            if (other != node && (!is_touched(other) || other > node))
+            {
+                evaluatePair(state, node, other);
+            }
+        }
+        evaluateReplacements(state, node);
+    }
+
+    if (removed != NO_REPLACEMENT)
+    {
+        // the inserted node can no longer replace anything, and the removed one may
+        // now be the best replacement elsewhere
+        for (int tour_node : state.tour())
+        {
+            if (is_touched(tour_node))
+            {
+                continue;
+            }
+            if (m_best_replacement[tour_node] == op.m_second_idx)
+            {
+                evaluateReplacements(state, tour_node);
+            }
+            else
+            {
+                offerReplacement(state, tour_node, removed);
+            }
+        }
+    }
+}
@@ -66,15 +66,26 @@ Nodes importNodesFromFile(const std::string &filename)
 
 DistanceMatrix calculateDistanceMatrix(const Nodes &nodes)
 {
-    DistanceMatrix dist(nodes.size(), std::vector<int>(nodes.size(), 0));
+    DistanceMatrix dist(nodes.size());
     for (int i = 0; i < nodes.size(); ++i)
     {
+        auto row = dist[i];
         for (int j = i + 1; j < nodes.size(); ++j)
         {
             int distance = nodes[i].distanceTo(nodes[j]);
-            dist[i][j] = distance;
+            row[j] = distance;
             dist[j][i] = distance;
         }
     }
     return dist;
-}
\ No newline at end of file
+}
+std::vector<int> collectWeights(const Nodes &nodes)
+{
+    std::vector<int> weights;
+    weights.reserve(nodes.size());
+    for (const Node &node : nodes)
+    {
+        weights.push_back(node.getWeight());
+    }
+    return weights;
+}
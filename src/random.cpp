@@ -1,41 +1,147 @@
 #include "random.hpp"
 
 #include <algorithm>
+#include <bit>
 #include <numeric>
+#include <stdexcept>
+
+void Rng::seed(std::uint64_t seed)
+{
+    for (std::uint64_t &word : m_state)
+    {
+        seed += 0x9e3779b97f4a7c15;
+        std::uint64_t mixed = seed;
+        mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111eb;
+        word = mixed ^ (mixed >> 31);
+    }
+}
+
+void Rng::jump()
+{
+    constexpr std::uint64_t JUMP[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+    std::uint64_t jumped[4] = {0, 0, 0, 0};
+    for (std::uint64_t word : JUMP)
+    {
+        for (int bit = 0; bit < 64; ++bit)
+        {
+            if (word & (std::uint64_t(1) << bit))
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    jumped[i] ^= m_state[i];
+                }
+            }
+            (*this)();
+        }
+    }
+    std::copy(jumped, jumped + 4, m_state);
+}
+
+Rng Rng::split()
+{
+    Rng stream = *this;
+    jump();
+    return stream;
+}
 
 std::vector<int> shuffledIndices(
-    std::size_t size, std::default_random_engine &rng)
+    std::size_t size, Rng &rng)
 {
     std::vector<int> indices(size);
     std::iota(std::begin(indices), std::end(indices), 0);
-    std::shuffle(std::begin(indices), std::end(indices), rng);
+    for (std::size_t i = size; i > 1; --i)
+    {
+        std::swap(indices[i - 1], indices[rng.below(i)]);
+    }
     return indices;
 };
 
-std::default_random_engine &getRandomEngine()
+void WeightedSampler::assign(const std::vector<int> &weights)
 {
-    static std::default_random_engine rng;
-    return rng;
-};
+    const int size = weights.size();
+    m_weights = weights;
+    m_tree.assign(size + 1, 0);
+    m_total = 0;
+    for (int i = 1; i <= size; ++i)
+    {
+        if (weights[i - 1] < 0)
+        {
+            throw std::runtime_error("Weights cannot be negative");
+        }
+        m_total += weights[i - 1];
+        m_tree[i] += weights[i - 1];
+        int parent = i + (i & -i);
+        if (parent <= size)
+        {
+            m_tree[parent] += m_tree[i];
+        }
+    }
+}
 
-std::vector<int> sampleWeightedWithoutReplacement(
-    std::vector<int> &weights,
-    int sample_size,
-    std::default_random_engine &rng)
+void WeightedSampler::set(int index, int weight)
 {
-    if (sample_size > weights.size())
+    if (weight < 0)
     {
-        throw std::runtime_error("Sample size cannot be larger than the number of weights");
+        throw std::runtime_error("Weights cannot be negative");
     }
-    std::vector<int> samples;
+    long long change = weight - m_weights[index];
+    m_weights[index] = weight;
+    m_total += change;
+    for (int i = index + 1; i < m_tree.size(); i += i & -i)
+    {
+        m_tree[i] += change;
+    }
+}
+
+int WeightedSampler::sample(Rng &rng) const
+{
+    if (m_total == 0)
+    {
+        throw std::runtime_error("Cannot sample from zero total weight");
+    }
+    // descend to the first index whose prefix sum exceeds the drawn value
+    long long remaining = rng.below(m_total);
+    const int size = m_weights.size();
+    int position = 0;
+    for (int step = std::bit_floor(static_cast<unsigned>(size)); step > 0; step >>= 1)
+    {
+        if (position + step <= size && m_tree[position + step] <= remaining)
+        {
+            position += step;
+            remaining -= m_tree[position];
+        }
+    }
+    return position;
+}
 
+void WeightedSampler::sampleWithoutReplacement(int sample_size, Rng &rng, std::vector<int> &samples)
+{
+    if (sample_size > m_weights.size())
+    {
+        throw std::runtime_error("Sample size cannot be larger than the number of weights");
+    }
+    samples.clear();
     for (int i = 0; i < sample_size; ++i)
     {
-        std::discrete_distribution<int> dist(std::begin(weights), std::end(weights));
-        int sample = dist(rng);
-        samples.push_back(sample);
-        weights[sample] = 0;
+        int drawn = sample(rng);
+        samples.push_back(drawn);
+        set(drawn, 0);
     }
+}
 
+std::vector<int> sampleWeightedWithoutReplacement(
+    std::vector<int> &weights,
+    int sample_size,
+    Rng &rng)
+{
+    WeightedSampler sampler;
+    sampler.assign(weights);
+    std::vector<int> samples;
+    sampler.sampleWithoutReplacement(sample_size, rng, samples);
+    for (int sample : samples)
+    {
+        weights[sample] = 0;
+    }
     return samples;
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #include "solution.hpp"
 
+#include <algorithm>
 #include <fstream>
 
 int evaluateSolution(const Nodes &nodes, const Solution &solution)
@@ -60,19 +61,19 @@ Solution importSolutionFromFile(const std::string &filename)
     return solution;
 }
 
-Solution swapNodes(Solution &solution, int first_idx, int second_idx)
+Solution &swapNodes(Solution &solution, int first_idx, int second_idx)
 {
     std::swap(solution[first_idx], solution[second_idx]);
     return solution;
 }
 
-Solution replaceNode(Solution &solution, int sol_idx, int node_idx)
+Solution &replaceNode(Solution &solution, int sol_idx, int node_idx)
 {
     solution[sol_idx] = node_idx;
     return solution;
 }
 
-Solution swapEdges(Solution &solution, int first_idx, int second_idx)
+Solution &swapEdges(Solution &solution, int first_idx, int second_idx)
 {
     int idx_diff = std::abs(first_idx - second_idx);
     if (
@@ -90,4 +91,24 @@ Solution swapEdges(Solution &solution, int first_idx, int second_idx)
     std::reverse(solution.begin() + first_idx + 1, solution.begin() + second_idx + 1);
 
     return solution;
-}
\ No newline at end of file
+}
+
+Solution &moveSegment(Solution &solution, int first_idx, int length, int target_idx, bool reversed)
+{
+    int segment_start = first_idx;
+    if (target_idx > first_idx)
+    {
+        std::rotate(solution.begin() + first_idx, solution.begin() + first_idx + length, solution.begin() + target_idx + 1);
+        segment_start = target_idx + 1 - length;
+    }
+    else
+    {
+        std::rotate(solution.begin() + target_idx + 1, solution.begin() + first_idx, solution.begin() + first_idx + length);
+        segment_start = target_idx + 1;
+    }
+    if (reversed)
+    {
+        std::reverse(solution.begin() + segment_start, solution.begin() + segment_start + length);
+    }
+    return solution;
+}
@@ -4,8 +4,10 @@
 #include <iostream>
 
 #include "solvers.hpp"
+#include "indexed_heap.hpp"
+#include "spatial_index.hpp"
 
-Solution AbstractSolver::solve(const Nodes &nodes, int start_idx, int visit_count)
+Solution AbstractSolver::solve(const NodesDistPair &nodes, int start_idx, int visit_count)
 {
     beforeSolve(nodes, start_idx);
     Solution solution = _solve(nodes, start_idx, visit_count);
@@ -13,72 +15,67 @@ Solution AbstractSolver::solve(const Nodes &nodes, int start_idx, int visit_coun
     return solution;
 }
 
-Solution RandomSolver::_solve(const Nodes &nodes, int start_idx, int visit_count)
+Solution RandomSolver::_solve(const NodesDistPair &nodes, int start_idx, int visit_count)
 {
-    Solution indices = shuffledIndices(nodes.size(), m_rng);
+    Solution indices = shuffledIndices(nodes.nodes.size(), m_rng);
     indices.resize(visit_count);
     return indices;
 }
 
-void RandomSolver::beforeSolve(const Nodes &nodes, int start_idx)
+void RandomSolver::beforeSolve(const NodesDistPair &nodes, int start_idx)
 {
     m_rng.seed(start_idx + 1000);
 }
 
-Solution NearestNeighbourSolver::_solve(const Nodes &nodes, int start_idx, int visit_count)
+Solution NearestNeighbourSolver::_solve(const NodesDistPair &nodes, int start_idx, int visit_count)
 {
     Solution solution = m_starting_solution;
-    std::vector<bool> visited(nodes.size(), false);
     if (solution.empty())
     {
         solution.push_back(start_idx);
     }
 
+    SpatialIndex index(nodes.nodes);
     for (int i : solution)
     {
-        visited[i] = true;
+        index.deactivate(i);
     }
 
     int current_idx = solution[solution.size() - 1];
 
     for (int i = 0; i < visit_count - 1; ++i)
     {
-        int min_score = std::numeric_limits<int>::max();
-        int min_idx = -1;
-        for (int j = 0; j < nodes.size(); ++j)
-        {
-            if (visited[j])
-            {
-                continue;
-            }
-            int score = m_distances[current_idx][j] + nodes[j].getWeight();
-            if (score < min_score)
-            {
-                min_score = score;
-                min_idx = j;
-            }
-        }
+        int min_idx = index.nearestActive(current_idx);
         solution.push_back(min_idx);
 
-        visited[min_idx] = true;
+        index.deactivate(min_idx);
         current_idx = min_idx;
     }
     return solution;
 }
 
-void NearestNeighbourSolver::beforeSolve(const Nodes &nodes, int start_idx)
+static inline int insertionCost(const NodesDistPair &nodes, int node, int from, int to)
 {
-    m_distances = calculateDistanceMatrix(nodes);
+    return nodes.dist[from][node] + nodes.dist[node][to] - nodes.dist[from][to] + nodes.nodes[node].getWeight();
 }
 
-Solution GreedyCycleSolver::_solve(const Nodes &nodes, int start_idx, int visit_count)
+Solution GreedyCycleSolver::_solve(const NodesDistPair &nodes, int start_idx, int visit_count)
+{
+    if (m_incremental)
+    {
+        return solveIncremental(nodes, start_idx, visit_count);
+    }
+    return solveExhaustive(nodes, start_idx, visit_count);
+}
+
+Solution GreedyCycleSolver::solveExhaustive(const NodesDistPair &nodes, int start_idx, int visit_count)
 {
     Solution solution = m_starting_solution;
     if (solution.empty())
     {
-        solution = initializeTwoCheapest(nodes, start_idx, m_distances);
+        solution = initializeTwoCheapest(nodes.nodes, start_idx, nodes.dist);
     }
-    std::vector<bool> visited(nodes.size(), false);
+    std::vector<bool> visited(nodes.nodes.size(), false);
 
     for (int i : solution)
     {
@@ -91,16 +88,16 @@ Solution GreedyCycleSolver::_solve(const Nodes &nodes, int start_idx, int visit_
         int added_idx = -1;
         int min_increase = std::numeric_limits<int>::max();
 
-        for (int i = 0; i < nodes.size(); ++i)
+        for (int i = 0; i < nodes.nodes.size(); ++i)
         {
             if (visited[i])
                 continue;
             for (int j = 0; j < solution.size(); ++j)
             {
                 int next_idx = (j + 1) % solution.size();
-                int increase = m_distances[solution[j]][i] + m_distances[i][solution[next_idx]];
-                increase -= m_distances[solution[j]][solution[next_idx]];
-                increase += nodes[i].getWeight();
+                int increase = nodes.dist[solution[j]][i] + nodes.dist[i][solution[next_idx]];
+                increase -= nodes.dist[solution[j]][solution[next_idx]];
+                increase += nodes.nodes[i].getWeight();
                 if (increase < min_increase)
                 {
                     min_increase = increase;
@@ -117,13 +114,121 @@ Solution GreedyCycleSolver::_solve(const Nodes &nodes, int start_idx, int visit_
     return solution;
 }
 
-Solution GreedyTwoRegretSolver::_solve(const Nodes &nodes, int start_idx, int visit_count)
+Solution GreedyCycleSolver::solveIncremental(const NodesDistPair &nodes, int start_idx, int visit_count)
+{
+    Solution solution = m_starting_solution;
+    if (solution.empty())
+    {
+        solution = initializeTwoCheapest(nodes.nodes, start_idx, nodes.dist);
+    }
+    const int num_nodes = nodes.nodes.size();
+    std::vector<bool> visited(num_nodes, false);
+    std::vector<int> position(num_nodes, -1);
+    for (int i = 0; i < solution.size(); ++i)
+    {
+        visited[solution[i]] = true;
+        position[solution[i]] = i;
+    }
+
+    // Tour edges are identified by their starting node, the table keeps the cheapest
+    // edge for every unvisited node with ties resolved towards the earlier tour position.
+    std::vector<int> best_increase(num_nodes, std::numeric_limits<int>::max());
+    std::vector<int> best_from(num_nodes, -1);
+
+    auto rescan = [&](int node)
+    {
+        best_increase[node] = std::numeric_limits<int>::max();
+        for (int j = 0; j < solution.size(); ++j)
+        {
+            int increase = insertionCost(nodes, node, solution[j], solution[(j + 1) % solution.size()]);
+            if (increase < best_increase[node])
+            {
+                best_increase[node] = increase;
+                best_from[node] = solution[j];
+            }
+        }
+    };
+
+    auto offer = [&](int node, int from, int to)
+    {
+        int increase = insertionCost(nodes, node, from, to);
+        if (increase < best_increase[node] ||
+            (increase == best_increase[node] && position[from] < position[best_from[node]]))
+        {
+            best_increase[node] = increase;
+            best_from[node] = from;
+        }
+    };
+
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        if (!visited[i])
+        {
+            rescan(i);
+        }
+    }
+
+    while (solution.size() < visit_count)
+    {
+        int nearest_idx = -1;
+        int min_increase = std::numeric_limits<int>::max();
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            if (!visited[i] && best_increase[i] < min_increase)
+            {
+                min_increase = best_increase[i];
+                nearest_idx = i;
+            }
+        }
+
+        int from = best_from[nearest_idx];
+        int added_idx = position[from];
+        int to = solution[(added_idx + 1) % solution.size()];
+        solution.insert(solution.begin() + added_idx + 1, nearest_idx);
+        visited[nearest_idx] = true;
+        for (int j = added_idx + 1; j < solution.size(); ++j)
+        {
+            position[solution[j]] = j;
+        }
+
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            if (visited[i])
+                continue;
+            if (best_from[i] == from)
+            {
+                rescan(i);
+                continue;
+            }
+            offer(i, from, nearest_idx);
+            offer(i, nearest_idx, to);
+        }
+    }
+
+    return solution;
+}
+
+int GreedyTwoRegretSolver::regret(int min_increase, int second_min_increase) const
+{
+    return std::round(second_min_increase * m_second_weight) - std::round(min_increase * m_first_weight);
+}
+
+Solution GreedyTwoRegretSolver::_solve(const NodesDistPair &nodes, int start_idx, int visit_count)
+{
+    if (m_incremental)
+    {
+        return solveIncremental(nodes, start_idx, visit_count);
+    }
+    return solveExhaustive(nodes, start_idx, visit_count);
+}
+
+Solution GreedyTwoRegretSolver::solveExhaustive(const NodesDistPair &nodes, int start_idx, int visit_count)
 {
     Solution solution = m_starting_solution;
-    std::vector<bool> visited(nodes.size(), false);
+    std::vector<bool> visited(nodes.nodes.size(), false);
     if (solution.empty())
     {
-        solution = initializeTwoCheapest(nodes, start_idx, m_distances);
+        solution = initializeTwoCheapest(nodes.nodes, start_idx, nodes.dist);
     }
     for (int i : solution)
     {
@@ -137,7 +242,7 @@ Solution GreedyTwoRegretSolver::_solve(const Nodes &nodes, int start_idx, int vi
 
         int max_regret = std::numeric_limits<int>::min();
 
-        for (int i = 0; i < nodes.size(); ++i)
+        for (int i = 0; i < nodes.nodes.size(); ++i)
         {
             if (visited[i])
                 continue;
@@ -149,9 +254,9 @@ Solution GreedyTwoRegretSolver::_solve(const Nodes &nodes, int start_idx, int vi
             for (int j = 0; j < solution.size(); ++j)
             {
                 int next_idx = (j + 1) % solution.size();
-                int increase = m_distances[solution[j]][i] + m_distances[i][solution[next_idx]];
-                increase -= m_distances[solution[j]][solution[next_idx]];
-                increase += nodes[i].getWeight();
+                int increase = nodes.dist[solution[j]][i] + nodes.dist[i][solution[next_idx]];
+                increase -= nodes.dist[solution[j]][solution[next_idx]];
+                increase += nodes.nodes[i].getWeight();
                 if (increase <= min_increase)
                 {
                     second_min_increase = min_increase;
@@ -163,10 +268,10 @@ Solution GreedyTwoRegretSolver::_solve(const Nodes &nodes, int start_idx, int vi
                     second_min_increase = increase;
                 }
             }
-            int regret = std::round(second_min_increase * m_second_weight) - std::round(min_increase * m_first_weight);
-            if (regret > max_regret)
+            int node_regret = regret(min_increase, second_min_increase);
+            if (node_regret > max_regret)
             {
-                max_regret = regret;
+                max_regret = node_regret;
                 nearest_idx = i;
                 best_added_idx = added_idx;
             }
@@ -178,12 +283,127 @@ Solution GreedyTwoRegretSolver::_solve(const Nodes &nodes, int start_idx, int vi
     return solution;
 }
 
-std::unique_ptr<AbstractSolver> createSolver(char name, double weigth1, double weight2)
+Solution GreedyTwoRegretSolver::solveIncremental(const NodesDistPair &nodes, int start_idx, int visit_count)
+{
+    Solution solution = m_starting_solution;
+    if (solution.empty())
+    {
+        solution = initializeTwoCheapest(nodes.nodes, start_idx, nodes.dist);
+    }
+    const int num_nodes = nodes.nodes.size();
+    std::vector<bool> visited(num_nodes, false);
+    std::vector<int> position(num_nodes, -1);
+    for (int i = 0; i < solution.size(); ++i)
+    {
+        visited[solution[i]] = true;
+        position[solution[i]] = i;
+    }
+
+    // Two cheapest insertion edges per unvisited node, identified by their starting node.
+    // The best one is the last tour position reaching the minimum, as in the exhaustive scan.
+    std::vector<int> min_increase(num_nodes, std::numeric_limits<int>::max());
+    std::vector<int> second_min_increase(num_nodes, std::numeric_limits<int>::max());
+    std::vector<int> best_from(num_nodes, -1);
+    std::vector<int> second_from(num_nodes, -1);
+    IndexedHeap<int, std::greater<int>> regrets(num_nodes);
+
+    auto rescan = [&](int node)
+    {
+        min_increase[node] = std::numeric_limits<int>::max();
+        second_min_increase[node] = std::numeric_limits<int>::max();
+        for (int j = 0; j < solution.size(); ++j)
+        {
+            int increase = insertionCost(nodes, node, solution[j], solution[(j + 1) % solution.size()]);
+            if (increase <= min_increase[node])
+            {
+                second_min_increase[node] = min_increase[node];
+                second_from[node] = best_from[node];
+                min_increase[node] = increase;
+                best_from[node] = solution[j];
+            }
+            else if (increase < second_min_increase[node])
+            {
+                second_min_increase[node] = increase;
+                second_from[node] = solution[j];
+            }
+        }
+    };
+
+    auto offer = [&](int node, int from, int to)
+    {
+        int increase = insertionCost(nodes, node, from, to);
+        if (increase < min_increase[node] ||
+            (increase == min_increase[node] && position[from] > position[best_from[node]]))
+        {
+            second_min_increase[node] = min_increase[node];
+            second_from[node] = best_from[node];
+            min_increase[node] = increase;
+            best_from[node] = from;
+            return true;
+        }
+        if (increase < second_min_increase[node])
+        {
+            second_min_increase[node] = increase;
+            second_from[node] = from;
+            return true;
+        }
+        return false;
+    };
+
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        if (!visited[i])
+        {
+            rescan(i);
+            regrets.update(i, regret(min_increase[i], second_min_increase[i]));
+        }
+    }
+
+    while (solution.size() < visit_count)
+    {
+        int nearest_idx = regrets.top();
+        regrets.pop();
+
+        int from = best_from[nearest_idx];
+        int added_idx = position[from];
+        int to = solution[(added_idx + 1) % solution.size()];
+        solution.insert(solution.begin() + added_idx + 1, nearest_idx);
+        visited[nearest_idx] = true;
+        for (int j = added_idx + 1; j < solution.size(); ++j)
+        {
+            position[solution[j]] = j;
+        }
+
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            if (visited[i])
+                continue;
+            bool changed;
+            if (best_from[i] == from || second_from[i] == from)
+            {
+                rescan(i);
+                changed = true;
+            }
+            else
+            {
+                changed = offer(i, from, nearest_idx);
+                changed |= offer(i, nearest_idx, to);
+            }
+            if (changed)
+            {
+                regrets.update(i, regret(min_increase[i], second_min_increase[i]));
+            }
+        }
+    }
+    return solution;
+}
+
+std::unique_ptr<AbstractSolver> createSolver(char name, double weigth1, double weight2, Rng &rng)
 {
     switch (name)
     {
     case 'r':
-        return std::make_unique<RandomSolver>();
+        return std::make_unique<RandomSolver>(rng);
     case 'n':
         return std::make_unique<NearestNeighbourSolver>();
     case 'g':
@@ -0,0 +1,190 @@
+#include "spatial_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+constexpr static int NO_WEIGHT = std::numeric_limits<int>::max();
+
+SpatialIndex::SpatialIndex(const Nodes &nodes)
+    : m_nodes(nodes),
+      m_order(nodes.size()),
+      m_position(nodes.size()),
+      m_boxes(nodes.size()),
+      m_split_x(nodes.size(), true),
+      m_min_weight(nodes.size(), NO_WEIGHT),
+      m_min_active_weight(nodes.size(), NO_WEIGHT),
+      m_active(nodes.size(), true)
+{
+    std::iota(m_order.begin(), m_order.end(), 0);
+    build(0, m_order.size());
+    for (int i = 0; i < m_order.size(); ++i)
+    {
+        m_position[m_order[i]] = i;
+    }
+    m_min_active_weight = m_min_weight;
+}
+
+int SpatialIndex::build(int lo, int hi)
+{
+    if (lo >= hi)
+    {
+        return NO_WEIGHT;
+    }
+
+    Box box{
+        std::numeric_limits<int>::max(), std::numeric_limits<int>::min(),
+        std::numeric_limits<int>::max(), std::numeric_limits<int>::min()};
+    for (int i = lo; i < hi; ++i)
+    {
+        const Node &node = m_nodes[m_order[i]];
+        box.min_x = std::min(box.min_x, node.getX());
+        box.max_x = std::max(box.max_x, node.getX());
+        box.min_y = std::min(box.min_y, node.getY());
+        box.max_y = std::max(box.max_y, node.getY());
+    }
+
+    int mid = (lo + hi) / 2;
+    bool split_x = box.max_x - box.min_x >= box.max_y - box.min_y;
+    std::nth_element(
+        m_order.begin() + lo, m_order.begin() + mid, m_order.begin() + hi,
+        [&](int a, int b)
+        {
+            int key_a = split_x ? m_nodes[a].getX() : m_nodes[a].getY();
+            int key_b = split_x ? m_nodes[b].getX() : m_nodes[b].getY();
+            return key_a < key_b || (key_a == key_b && a < b);
+        });
+
+    m_boxes[mid] = box;
+    m_split_x[mid] = split_x;
+    int min_weight = m_nodes[m_order[mid]].getWeight();
+    min_weight = std::min(min_weight, build(lo, mid));
+    min_weight = std::min(min_weight, build(mid + 1, hi));
+    m_min_weight[mid] = min_weight;
+    return min_weight;
+}
+
+int SpatialIndex::lowerBound(const Box &box, const Node &query) const noexcept
+{
+    int dx = std::max({0, box.min_x - query.getX(), query.getX() - box.max_x});
+    int dy = std::max({0, box.min_y - query.getY(), query.getY() - box.max_y});
+    return std::round(std::sqrt(dx * dx + dy * dy));
+}
+
+void SpatialIndex::search(
+    int lo, int hi, const Node &query, int excluded, bool active_only, int k, std::vector<Candidate> &best) const
+{
+    if (lo >= hi)
+    {
+        return;
+    }
+    int mid = (lo + hi) / 2;
+    int min_weight = active_only ? m_min_active_weight[mid] : m_min_weight[mid];
+    if (min_weight == NO_WEIGHT)
+    {
+        return;
+    }
+    if (static_cast<int>(best.size()) == k && lowerBound(m_boxes[mid], query) + min_weight > best.front().score)
+    {
+        return;
+    }
+
+    int node = m_order[mid];
+    if (node != excluded && (!active_only || m_active[node]))
+    {
+        Candidate candidate{query.distanceTo(m_nodes[node]) + m_nodes[node].getWeight(), node};
+        if (static_cast<int>(best.size()) < k)
+        {
+            best.push_back(candidate);
+            std::push_heap(best.begin(), best.end());
+        }
+        else if (candidate < best.front())
+        {
+            std::pop_heap(best.begin(), best.end());
+            best.back() = candidate;
+            std::push_heap(best.begin(), best.end());
+        }
+    }
+
+    int query_key = m_split_x[mid] ? query.getX() : query.getY();
+    int pivot_key = m_split_x[mid] ? m_nodes[node].getX() : m_nodes[node].getY();
+    if (query_key < pivot_key)
+    {
+        search(lo, mid, query, excluded, active_only, k, best);
+        search(mid + 1, hi, query, excluded, active_only, k, best);
+    }
+    else
+    {
+        search(mid + 1, hi, query, excluded, active_only, k, best);
+        search(lo, mid, query, excluded, active_only, k, best);
+    }
+}
+
+std::vector<int> SpatialIndex::kNearest(int node, int k) const
+{
+    std::vector<Candidate> best;
+    best.reserve(k);
+    search(0, m_order.size(), m_nodes[node], node, false, k, best);
+    std::sort_heap(best.begin(), best.end());
+
+    std::vector<int> nearest(best.size());
+    for (int i = 0; i < best.size(); ++i)
+    {
+        nearest[i] = best[i].node;
+    }
+    return nearest;
+}
+
+int SpatialIndex::nearestActive(int node) const
+{
+    std::vector<Candidate> best;
+    best.reserve(1);
+    search(0, m_order.size(), m_nodes[node], node, true, 1, best);
+    return best.empty() ? -1 : best.front().node;
+}
+
+void SpatialIndex::deactivate(int node)
+{
+    setActive(node, false);
+}
+
+void SpatialIndex::activate(int node)
+{
+    setActive(node, true);
+}
+
+void SpatialIndex::setActive(int node, bool active)
+{
+    if (m_active[node] == active)
+    {
+        return;
+    }
+    m_active[node] = active;
+    refreshActiveWeight(0, m_order.size(), m_position[node]);
+}
+
+int SpatialIndex::refreshActiveWeight(int lo, int hi, int position)
+{
+    int mid = (lo + hi) / 2;
+    if (position < mid)
+    {
+        refreshActiveWeight(lo, mid, position);
+    }
+    else if (position > mid)
+    {
+        refreshActiveWeight(mid + 1, hi, position);
+    }
+
+    int min_weight = m_active[m_order[mid]] ? m_nodes[m_order[mid]].getWeight() : NO_WEIGHT;
+    if (lo < mid)
+    {
+        min_weight = std::min(min_weight, m_min_active_weight[(lo + mid) / 2]);
+    }
+    if (mid + 1 < hi)
+    {
+        min_weight = std::min(min_weight, m_min_active_weight[(mid + 1 + hi) / 2]);
+    }
+    m_min_active_weight[mid] = min_weight;
+    return min_weight;
+}
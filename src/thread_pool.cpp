@@ -0,0 +1,83 @@
+#include "thread_pool.hpp"
+
+#include <stdexcept>
+
+ThreadPool::ThreadPool(int num_threads)
+{
+    if (num_threads < 1)
+    {
+        throw std::runtime_error("Thread pool needs at least one thread");
+    }
+    m_workers.reserve(num_threads - 1);
+    for (int i = 1; i < num_threads; ++i)
+    {
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_start.notify_all();
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(int num_tasks, const std::function<void(int)> &task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_num_tasks = num_tasks;
+        m_next_task = 0;
+        m_busy = m_workers.size() + 1;
+        ++m_generation;
+    }
+    m_start.notify_all();
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]
+                { return m_busy == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::work()
+{
+    unsigned seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&]
+                         { return m_stopping || m_generation != seen; });
+            if (m_stopping)
+            {
+                return;
+            }
+            seen = m_generation;
+        }
+        runTasks();
+    }
+}
+
+void ThreadPool::runTasks()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_next_task < m_num_tasks)
+    {
+        int task = m_next_task++;
+        lock.unlock();
+        (*m_task)(task);
+        lock.lock();
+    }
+    if (--m_busy == 0)
+    {
+        m_done.notify_one();
+    }
+}
@@ -0,0 +1,117 @@
+#include "tour_state.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+TourState::TourState(const Solution &solution, int num_nodes)
+    : m_tour(solution),
+      m_position(num_nodes, OUTSIDE),
+      m_in_tour(num_nodes, false),
+      m_outside_slot(num_nodes, OUTSIDE)
+{
+    for (int i = 0; i < m_tour.size(); ++i)
+    {
+        if (m_tour[i] < 0 || m_tour[i] >= num_nodes || m_in_tour[m_tour[i]])
+        {
+            throw std::runtime_error("Invalid tour for TourState");
+        }
+        m_position[m_tour[i]] = i;
+        m_in_tour[m_tour[i]] = true;
+    }
+    m_outside.reserve(num_nodes - m_tour.size());
+    for (int node = 0; node < num_nodes; ++node)
+    {
+        if (!m_in_tour[node])
+        {
+            m_outside_slot[node] = m_outside.size();
+            m_outside.push_back(node);
+        }
+    }
+}
+
+void TourState::swapNodes(int first_idx, int second_idx)
+{
+    std::swap(m_tour[first_idx], m_tour[second_idx]);
+    m_position[m_tour[first_idx]] = first_idx;
+    m_position[m_tour[second_idx]] = second_idx;
+}
+
+void TourState::replaceNode(int sol_idx, int node_idx)
+{
+    // a node already in the tour has no outside slot to take over
+    assert(!m_in_tour[node_idx]);
+    int old_node = m_tour[sol_idx];
+    int slot = m_outside_slot[node_idx];
+    m_outside[slot] = old_node;
+    m_outside_slot[old_node] = slot;
+    m_outside_slot[node_idx] = OUTSIDE;
+
+    m_tour[sol_idx] = node_idx;
+    m_position[node_idx] = sol_idx;
+    m_position[old_node] = OUTSIDE;
+    m_in_tour[node_idx] = true;
+    m_in_tour[old_node] = false;
+}
+
+void TourState::swapEdges(int first_idx, int second_idx)
+{
+    int idx_diff = std::abs(first_idx - second_idx);
+    if (idx_diff < 2 || idx_diff == m_tour.size() - 1)
+    {
+        return;
+    }
+    if (first_idx > second_idx)
+    {
+        std::swap(first_idx, second_idx);
+    }
+
+    // Both sides give the same cycle, so the shorter one is reversed. The outer side
+    // wraps around the end of the array.
+    const int size = m_tour.size();
+    int left = first_idx + 1;
+    int right = second_idx;
+    int length = second_idx - first_idx;
+    if (2 * length > size)
+    {
+        left = second_idx + 1 == size ? 0 : second_idx + 1;
+        right = first_idx;
+        length = size - length;
+    }
+    for (int i = 0; i < length / 2; ++i)
+    {
+        int left_node = m_tour[left];
+        int right_node = m_tour[right];
+        m_tour[left] = right_node;
+        m_tour[right] = left_node;
+        m_position[right_node] = left;
+        m_position[left_node] = right;
+        left = left + 1 == size ? 0 : left + 1;
+        right = right == 0 ? size - 1 : right - 1;
+    }
+}
+
+void TourState::reversePath(int from, int to)
+{
+    int from_idx = m_position[from];
+    swapEdges(from_idx == 0 ? size() - 1 : from_idx - 1, m_position[to]);
+}
+
+bool TourState::between(int first, int middle, int last) const noexcept
+{
+    int first_idx = m_position[first];
+    int middle_offset = (m_position[middle] - first_idx + size()) % size();
+    int last_offset = (m_position[last] - first_idx + size()) % size();
+    return middle_offset <= last_offset;
+}
+
+void TourState::moveSegment(int first_idx, int length, int target_idx, bool reversed)
+{
+    ::moveSegment(m_tour, first_idx, length, target_idx, reversed);
+    int from = std::min(first_idx, target_idx + 1);
+    int to = std::max(first_idx + length - 1, target_idx);
+    for (int i = from; i <= to; ++i)
+    {
+        m_position[m_tour[i]] = i;
+    }
+}
@@ -51,10 +51,34 @@ int main(int argc, char **argv)
     subparam_2 = subparam_2.empty() ? "10" : subparam_2;
     int subparam_2_int = std::stod(subparam_2);
 
+    // pool size for s and m, island count for e and a
+    std::string threads = args.getCmdOption("-th");
+    threads = threads.empty() ? "1" : threads;
+    int threads_int = std::stoi(threads);
+    if (threads_int < 1)
+    {
+        std::cout << "Invalid thread count\n";
+        return 1;
+    }
+
     NodesDistPair nodes{importNodesFromFile(instance_filename)};
+    auto uses_candidates = [](char type)
+    {
+        return type == 'c' || type == 'b' || type == 'v';
+    };
+    if (args.cmdOptionExists("-cc") && (uses_candidates(improver_type[0]) || uses_candidates(sub_type[0])))
+    {
+        // candidate lists are persisted next to the instance and shared by all improvers
+        loadCandidateLists(nodes.nodes, param_int, instance_filename);
+    }
     Solution solution = importSolutionFromFile(solution_filename);
     auto resolved_ntype = getNeighborhoodType(ntype);
-    auto improver = createImprover(improver_type[0], resolved_ntype, param_int, sub_type[0], subparam_1_double, subparam_2_int);
+    if (threads_int > 1 && !improverUsesThreads(improver_type[0], resolved_ntype))
+    {
+        std::cout << "Warning: -th has no effect on this improver and neighborhood, running on one thread\n";
+    }
+    Rng rng;
+    auto improver = createImprover(improver_type[0], resolved_ntype, param_int, rng, sub_type[0], subparam_1_double, subparam_2_int, threads_int);
     const auto start = std::chrono::high_resolution_clock::now();
     solution = improver->improve(solution, nodes);
     const auto end = std::chrono::high_resolution_clock::now();
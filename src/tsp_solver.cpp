@@ -20,7 +20,7 @@ int main(int argc, char **argv)
     std::string output_filename = args.getCmdOption("-o");
     output_filename = output_filename.empty() ? "solution.txt" : output_filename;
 
-    Nodes nodes = importNodesFromFile(filename);
+    NodesDistPair nodes{importNodesFromFile(filename)};
 
     std::string start_idx_str = args.getCmdOption("-i");
     start_idx_str = start_idx_str.empty() ? "0" : start_idx_str;
@@ -29,9 +29,9 @@ int main(int argc, char **argv)
     std::string start_perc_str = args.getCmdOption("-p");
     start_perc_str = start_perc_str.empty() ? "100" : start_perc_str;
     double start_perc = std::stod(start_perc_str) / 100.0;
-    int visit_count = std::ceil(start_perc * nodes.size());
+    int visit_count = std::ceil(start_perc * nodes.nodes.size());
 
-    if (visit_count < 3 || visit_count > nodes.size())
+    if (visit_count < 3 || visit_count > nodes.nodes.size())
     {
         std::cout << "Invalid start perc count" << std::endl;
         return 1;
@@ -47,7 +47,8 @@ int main(int argc, char **argv)
     double weight_second = 2.0 - weight_first;
 
     char solver_name = args.getCmdOption("-s")[0];
-    auto solver = createSolver(solver_name, weight_first, weight_second);
+    Rng rng;
+    auto solver = createSolver(solver_name, weight_first, weight_second, rng);
 
     const auto start = std::chrono::high_resolution_clock::now();
     Solution solution;
@@ -60,9 +61,9 @@ int main(int argc, char **argv)
     const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
     int microseconds = elapsed.count() / repeat_count;
 
-    int score = evaluateSolution(nodes, solution);
+    int score = evaluateSolution(nodes.nodes, solution);
     exportSolutionToFile(solution, output_filename, score, microseconds);
-    std::cout << "Used nodes: " << solution.size() << " / " << nodes.size() << std::endl;
+    std::cout << "Used nodes: " << solution.size() << " / " << nodes.nodes.size() << std::endl;
     std::cout << "Score: " << score << std::endl;
     std::cout << "Time (per run): " << microseconds << " us\n";
     std::cout << "Solution exported to " << output_filename << std::endl;
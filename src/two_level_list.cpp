@@ -0,0 +1,322 @@
+#include "two_level_list.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+
+TwoLevelList::TwoLevelList(const Solution &solution, int num_nodes)
+    : m_size(solution.size()),
+      m_next(num_nodes, -1),
+      m_prev(num_nodes, -1),
+      m_parent(num_nodes, OUTSIDE),
+      m_id(num_nodes, 0),
+      m_outside_slot(num_nodes, OUTSIDE)
+{
+    if (solution.empty())
+    {
+        throw std::runtime_error("Empty tour for TwoLevelList");
+    }
+    for (int node : solution)
+    {
+        if (node < 0 || node >= num_nodes || m_parent[node] != OUTSIDE)
+        {
+            throw std::runtime_error("Invalid tour for TwoLevelList");
+        }
+        m_parent[node] = 0;
+    }
+    m_outside.reserve(num_nodes - m_size);
+    for (int node = 0; node < num_nodes; ++node)
+    {
+        if (m_parent[node] == OUTSIDE)
+        {
+            m_outside_slot[node] = m_outside.size();
+            m_outside.push_back(node);
+        }
+    }
+    build(solution);
+}
+
+void TwoLevelList::build(const Solution &order)
+{
+    const int group = std::max(8, static_cast<int>(std::sqrt(m_size)));
+    const int num_segments = (m_size + group - 1) / group;
+    // every reversal adds at most two segments, so the list is rebuilt after about
+    // sqrt(n) reversals, which keeps the amortized cost at O(sqrt(n))
+    m_max_segments = 2 * num_segments + 8;
+    m_segments.resize(num_segments);
+    m_segments.reserve(m_max_segments + 2);
+    for (int s = 0; s < num_segments; ++s)
+    {
+        int begin = s * group;
+        int end = std::min(begin + group, m_size);
+        for (int i = begin; i < end; ++i)
+        {
+            int node = order[i];
+            m_parent[node] = s;
+            m_id[node] = i - begin;
+            m_prev[node] = i == begin ? -1 : order[i - 1];
+            m_next[node] = i + 1 == end ? -1 : order[i + 1];
+        }
+        m_segments[s] = {false, order[begin], order[end - 1], (s + 1) % num_segments,
+                         (s - 1 + num_segments) % num_segments, s};
+    }
+}
+
+void TwoLevelList::renumber()
+{
+    int segment = 0;
+    for (int rank = 0; rank < static_cast<int>(m_segments.size()); ++rank)
+    {
+        m_segments[segment].rank = rank;
+        segment = m_segments[segment].next;
+    }
+}
+
+Solution TwoLevelList::tour() const
+{
+    Solution result;
+    result.reserve(m_size);
+    int node = head(0);
+    for (int i = 0; i < m_size; ++i)
+    {
+        result.push_back(node);
+        node = next(node);
+    }
+    return result;
+}
+
+int TwoLevelList::head(int segment) const noexcept
+{
+    const Segment &seg = m_segments[segment];
+    return seg.reversed ? seg.last : seg.first;
+}
+
+int TwoLevelList::tail(int segment) const noexcept
+{
+    const Segment &seg = m_segments[segment];
+    return seg.reversed ? seg.first : seg.last;
+}
+
+int TwoLevelList::offset(int node) const noexcept
+{
+    return m_segments[m_parent[node]].reversed ? -m_id[node] : m_id[node];
+}
+
+int TwoLevelList::next(int node) const noexcept
+{
+    const Segment &seg = m_segments[m_parent[node]];
+    if (seg.reversed)
+    {
+        return node == seg.first ? head(seg.next) : m_prev[node];
+    }
+    return node == seg.last ? head(seg.next) : m_next[node];
+}
+
+int TwoLevelList::prev(int node) const noexcept
+{
+    const Segment &seg = m_segments[m_parent[node]];
+    if (seg.reversed)
+    {
+        return node == seg.last ? tail(seg.prev) : m_next[node];
+    }
+    return node == seg.first ? tail(seg.prev) : m_prev[node];
+}
+
+bool TwoLevelList::between(int first, int middle, int last) const noexcept
+{
+    auto key = [this](int node)
+    { return std::make_tuple(m_segments[m_parent[node]].rank, offset(node)); };
+    auto first_key = key(first);
+    auto middle_key = key(middle);
+    auto last_key = key(last);
+    if (first_key <= last_key)
+    {
+        return first_key <= middle_key && middle_key <= last_key;
+    }
+    return first_key <= middle_key || middle_key <= last_key;
+}
+
+void TwoLevelList::splitBefore(int node)
+{
+    const int segment = m_parent[node];
+    if (head(segment) == node)
+    {
+        return;
+    }
+    // the part of the segment in front of the node moves to a new segment
+    const int added = m_segments.size();
+    Segment &seg = m_segments[segment];
+    Segment part = seg;
+    int cut;
+    if (seg.reversed)
+    {
+        cut = m_next[node];
+        part.first = cut;
+        seg.last = node;
+        m_next[node] = -1;
+        m_prev[cut] = -1;
+    }
+    else
+    {
+        cut = m_prev[node];
+        part.last = cut;
+        seg.first = node;
+        m_prev[node] = -1;
+        m_next[cut] = -1;
+    }
+    for (int moved = part.first; moved != -1; moved = m_next[moved])
+    {
+        m_parent[moved] = added;
+    }
+    part.next = segment;
+    m_segments[seg.prev].next = added;
+    seg.prev = added;
+    m_segments.push_back(part);
+    renumber();
+}
+
+void TwoLevelList::reverseWithin(int segment, int from, int to)
+{
+    Segment &seg = m_segments[segment];
+    if (seg.reversed)
+    {
+        std::swap(from, to);
+    }
+    m_scratch.clear();
+    for (int node = from;; node = m_next[node])
+    {
+        m_scratch.push_back(node);
+        if (node == to)
+        {
+            break;
+        }
+    }
+    const int before = m_prev[from];
+    const int after = m_next[to];
+    const int count = m_scratch.size();
+    for (int i = 0; i < count / 2; ++i)
+    {
+        std::swap(m_id[m_scratch[i]], m_id[m_scratch[count - 1 - i]]);
+    }
+    std::reverse(m_scratch.begin(), m_scratch.end());
+    for (int i = 0; i < count; ++i)
+    {
+        m_prev[m_scratch[i]] = i == 0 ? before : m_scratch[i - 1];
+        m_next[m_scratch[i]] = i + 1 == count ? after : m_scratch[i + 1];
+    }
+    if (before == -1)
+    {
+        seg.first = m_scratch.front();
+    }
+    else
+    {
+        m_next[before] = m_scratch.front();
+    }
+    if (after == -1)
+    {
+        seg.last = m_scratch.back();
+    }
+    else
+    {
+        m_prev[after] = m_scratch.back();
+    }
+}
+
+void TwoLevelList::reverseSegments(int first_segment, int last_segment)
+{
+    const int before = m_segments[first_segment].prev;
+    const int after = m_segments[last_segment].next;
+    for (int segment = first_segment;;)
+    {
+        Segment &seg = m_segments[segment];
+        const int following = seg.next;
+        seg.reversed = !seg.reversed;
+        std::swap(seg.next, seg.prev);
+        if (segment == last_segment)
+        {
+            break;
+        }
+        segment = following;
+    }
+    m_segments[before].next = last_segment;
+    m_segments[last_segment].prev = before;
+    m_segments[first_segment].next = after;
+    m_segments[after].prev = first_segment;
+    renumber();
+}
+
+void TwoLevelList::reversePath(int from, int to)
+{
+    const int outer_from = next(to);
+    if (from == to || outer_from == from)
+    {
+        return;
+    }
+    // reversing the rest of the tour gives the same cycle
+    const int outer_to = prev(from);
+    if (m_parent[from] == m_parent[to] && offset(from) <= offset(to))
+    {
+        reverseWithin(m_parent[from], from, to);
+        return;
+    }
+    if (m_parent[outer_from] == m_parent[outer_to] && offset(outer_from) <= offset(outer_to))
+    {
+        reverseWithin(m_parent[outer_from], outer_from, outer_to);
+        return;
+    }
+
+    splitBefore(from);
+    splitBefore(outer_from);
+    const int num_segments = m_segments.size();
+    int first_segment = m_parent[from];
+    int last_segment = m_parent[to];
+    int path_segments =
+        (m_segments[last_segment].rank - m_segments[first_segment].rank + num_segments) % num_segments + 1;
+    if (2 * path_segments > num_segments)
+    {
+        first_segment = m_parent[outer_from];
+        last_segment = m_parent[outer_to];
+    }
+    reverseSegments(first_segment, last_segment);
+
+    if (num_segments > m_max_segments)
+    {
+        build(tour());
+    }
+}
+
+void TwoLevelList::replace(int old_node, int new_node)
+{
+    int slot = m_outside_slot[new_node];
+    m_outside[slot] = old_node;
+    m_outside_slot[old_node] = slot;
+    m_outside_slot[new_node] = OUTSIDE;
+
+    Segment &seg = m_segments[m_parent[old_node]];
+    const int before = m_prev[old_node];
+    const int after = m_next[old_node];
+    m_parent[new_node] = m_parent[old_node];
+    m_id[new_node] = m_id[old_node];
+    m_prev[new_node] = before;
+    m_next[new_node] = after;
+    if (before == -1)
+    {
+        seg.first = new_node;
+    }
+    else
+    {
+        m_next[before] = new_node;
+    }
+    if (after == -1)
+    {
+        seg.last = new_node;
+    }
+    else
+    {
+        m_prev[after] = new_node;
+    }
+    m_parent[old_node] = OUTSIDE;
+    m_prev[old_node] = -1;
+    m_next[old_node] = -1;
+}
@@ -0,0 +1,147 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include "candidates.hpp"
+
+static Nodes randomNodes(int size, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    Nodes nodes;
+    for (int i = 0; i < size; ++i)
+    {
+        int x = rng() % 500;
+        int y = rng() % 500;
+        nodes.emplace_back(x, y, rng() % 100);
+    }
+    return nodes;
+}
+
+void testCandidateListsAreSharedPerInstanceAndSize()
+{
+    Nodes nodes = randomNodes(50, 1);
+    Nodes same_nodes = nodes;
+    auto first = getCandidateLists(nodes, 5);
+    assert(first == getCandidateLists(same_nodes, 5));
+    assert(first != getCandidateLists(nodes, 6));
+    assert(first != getCandidateLists(randomNodes(50, 2), 5));
+
+    assert(first->numNodes() == 50);
+    assert(first->numCandidates() == 5);
+    for (int i = 0; i < nodes.size(); ++i)
+    {
+        for (int candidate : (*first)[i])
+        {
+            assert(candidate != i);
+        }
+    }
+}
+
+void testCandidateListsCacheIsBounded()
+{
+    Nodes nodes = randomNodes(30, 100);
+    auto first = getCandidateLists(nodes, 4);
+    for (unsigned int seed = 101; seed < 200; ++seed)
+    {
+        getCandidateLists(randomNodes(30, seed), 4);
+    }
+    auto rebuilt = getCandidateLists(nodes, 4);
+    assert(rebuilt != first);
+    for (int i = 0; i < nodes.size(); ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            assert((*rebuilt)[i][j] == (*first)[i][j]);
+        }
+    }
+}
+
+void testCandidateListsArePersistedNextToInstance()
+{
+    const std::string instance = "test_candidates_instance.csv";
+    const std::string filename = candidateListsFilename(instance, 4);
+    Nodes nodes = randomNodes(40, 3);
+    auto lists = loadCandidateLists(nodes, 4, instance);
+    assert(lists == getCandidateLists(nodes, 4));
+
+    std::ifstream file(filename);
+    assert(file.is_open());
+    std::uint64_t fingerprint;
+    int num_nodes, num_candidates, candidate;
+    file >> fingerprint >> num_nodes >> num_candidates;
+    assert(fingerprint == fingerprintNodes(nodes));
+    assert(num_nodes == 40 && num_candidates == 4);
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        for (int j = 0; j < num_candidates; ++j)
+        {
+            file >> candidate;
+            assert(candidate == (*lists)[i][j]);
+        }
+    }
+    file.close();
+    std::remove(filename.c_str());
+}
+
+void testCandidateListsAreReadFromFile()
+{
+    const std::string instance = "test_candidates_stored.csv";
+    const std::string filename = candidateListsFilename(instance, 2);
+    Nodes nodes = randomNodes(10, 5);
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    file << fingerprintNodes(nodes) << " 10 2\n";
+    for (int i = 0; i < 10; ++i)
+    {
+        file << (i + 1) % 10 << ' ' << (i + 2) % 10 << '\n';
+    }
+    file.close();
+
+    auto lists = loadCandidateLists(nodes, 2, instance);
+    for (int i = 0; i < 10; ++i)
+    {
+        assert((*lists)[i][0] == (i + 1) % 10);
+        assert((*lists)[i][1] == (i + 2) % 10);
+    }
+    std::remove(filename.c_str());
+}
+
+void testCandidateListsRejectStaleFile()
+{
+    const std::string instance = "test_candidates_stale.csv";
+    const std::string filename = candidateListsFilename(instance, 3);
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    file << "1 30 3\n";
+    file.close();
+
+    Nodes nodes = randomNodes(30, 4);
+    CandidateLists expected(nodes, 3);
+    auto lists = loadCandidateLists(nodes, 3, instance);
+    for (int i = 0; i < nodes.size(); ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            assert((*lists)[i][j] == expected[i][j]);
+        }
+    }
+    std::remove(filename.c_str());
+}
+
+void testCandidateListsSurviveUnwritableDirectory()
+{
+    const std::string instance = "test_candidates_missing_dir/instance.csv";
+    Nodes nodes = randomNodes(20, 6);
+    auto lists = loadCandidateLists(nodes, 3, instance);
+    assert(lists->numNodes() == 20 && lists->numCandidates() == 3);
+    assert(lists == getCandidateLists(nodes, 3));
+    assert(!std::ifstream(candidateListsFilename(instance, 3)).is_open());
+}
+
+int main()
+{
+    testCandidateListsAreSharedPerInstanceAndSize();
+    testCandidateListsCacheIsBounded();
+    testCandidateListsArePersistedNextToInstance();
+    testCandidateListsAreReadFromFile();
+    testCandidateListsRejectStaleFile();
+    testCandidateListsSurviveUnwritableDirectory();
+}
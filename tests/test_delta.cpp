@@ -1,7 +1,10 @@
 #include "solution.hpp"
 #include "delta.hpp"
+#include <algorithm>
 #include <cassert>
+#include <climits>
 #include <iostream>
+#include <random>
 
 static Nodes nodes = {
     {0, 0, 5},
@@ -95,9 +98,105 @@ void testGetDeltaSwapEdges()
     assert(new_evaluation - original_evaluation == delta);
 }
 
+void testGetDeltaOrOpt()
+{
+    Solution solution = {0, 1, 2, 3, 4, 5, 6};
+    for (int length = 1; length <= 3; ++length)
+    {
+        for (int first_idx = 0; first_idx + length <= solution.size(); ++first_idx)
+        {
+            for (int target_idx = 0; target_idx < solution.size(); ++target_idx)
+            {
+                int offset = (target_idx - first_idx + 1 + solution.size()) % solution.size();
+                if (offset <= length)
+                {
+                    continue;
+                }
+                for (bool reversed : {false, true})
+                {
+                    Solution moved = solution;
+                    int delta = getOrOptDelta(nodes_dist_pair, moved, first_idx, length, target_idx, reversed);
+                    moveSegment(moved, first_idx, length, target_idx, reversed);
+                    assert(evaluateSolution(nodes, moved) - evaluateSolution(nodes, solution) == delta);
+                }
+            }
+        }
+    }
+}
+
+void testBatchKernelsMatchScalarDeltas()
+{
+    std::mt19937 rng(7);
+    Nodes random_nodes;
+    for (int i = 0; i < 60; ++i)
+    {
+        random_nodes.emplace_back(rng() % 500, rng() % 500, rng() % 300);
+    }
+    NodesDistPair pair(random_nodes);
+    Solution solution(60);
+    for (int i = 0; i < 60; ++i)
+    {
+        solution[i] = i;
+    }
+    std::shuffle(solution.begin(), solution.end(), rng);
+    Solution outside(solution.begin() + 37, solution.end());
+    solution.resize(37);
+
+    for (int count : {0, 5, 8, 19, 37})
+    {
+        for (int i = 0; i < solution.size(); ++i)
+        {
+            std::vector<int> seconds(count);
+            for (int &second : seconds)
+            {
+                second = rng() % solution.size();
+            }
+            BatchMin expected{INT_MAX, -1};
+            for (int k = 0; k < count; ++k)
+            {
+                int delta = getEdgesSwapDelta(pair, solution, i, seconds[k]);
+                if (delta < expected.delta)
+                {
+                    expected = {delta, k};
+                }
+            }
+            BatchMin edges = minEdgesSwapDelta(pair, solution, i, seconds.data(), count);
+            assert(edges.delta == expected.delta && edges.index == expected.index);
+
+            std::vector<int> candidates(outside.begin(), outside.begin() + std::min<int>(count, outside.size()));
+            expected = {INT_MAX, -1};
+            for (int k = 0; k < candidates.size(); ++k)
+            {
+                int delta = getReplaceNodeDelta(pair, solution, i, candidates[k]);
+                if (delta < expected.delta)
+                {
+                    expected = {delta, k};
+                }
+            }
+            BatchMin replacements = minReplaceNodeDelta(pair, solution, i, candidates.data(), candidates.size());
+            assert(replacements.delta == expected.delta && replacements.index == expected.index);
+        }
+    }
+}
+
+void testEdgeSwapGatherLimit()
+{
+    // rows are padded to 16 ints, which puts the last instance the AVX2 kernel can
+    // address at 46336 nodes
+    assert(edgeSwapGatherFits(0, 0));
+    assert(edgeSwapGatherFits(1000, 1008));
+    assert(edgeSwapGatherFits(46336, 46336));
+    assert(!edgeSwapGatherFits(46337, 46352));
+    assert(edgeSwapGatherFits(INT_MAX / 16, 16));
+    assert(!edgeSwapGatherFits(INT_MAX / 16 + 1, 16));
+}
+
 int main()
 {
     testGetDeltaReplaceNode();
     testGetDeltaSwapNodes();
     testGetDeltaSwapEdges();
+    testGetDeltaOrOpt();
+    testBatchKernelsMatchScalarDeltas();
+    testEdgeSwapGatherLimit();
 }
\ No newline at end of file
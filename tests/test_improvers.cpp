@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include "improvers.hpp"
+#include "move_cache.hpp"
+
+// threaded improvers in the same binary allocate concurrently
+static std::atomic<std::size_t> allocation_count{0};
+
+void *operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+static Nodes randomNodes(int size, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    Nodes nodes;
+    for (int i = 0; i < size; ++i)
+    {
+        int x = rng() % 1000;
+        int y = rng() % 1000;
+        nodes.emplace_back(x, y, rng() % 500);
+    }
+    return nodes;
+}
+
+// Every other node of the instance, visited with the given stride so the tour starts
+// far from any local optimum.
+static Solution strideTour(int num_nodes, int stride)
+{
+    Solution tour;
+    for (int i = 0; i < num_nodes; i += 2)
+    {
+        tour.push_back((i * stride) % num_nodes);
+    }
+    return tour;
+}
+
+static void assertDistinctNodes(const Solution &solution, std::size_t size)
+{
+    Solution sorted = solution;
+    std::sort(sorted.begin(), sorted.end());
+    assert(sorted.size() == size);
+    assert(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+}
+
+static void assertLocalOptimum(const Solution &solution, const NodesDistPair &nodes, NeighborhoodType type)
+{
+    for (Operation operation : getNeighborhoodOperations(solution, nodes.nodes.size(), type))
+    {
+        assert(OpData(operation).evaluate(solution, nodes) >= 0);
+    }
+}
+
+void testOperationEncodingRoundTrip()
+{
+    const int max_index = std::numeric_limits<int>::max();
+    OperationType types[] = {OperationType::NODE_SWAP, OperationType::EDGE_SWAP, OperationType::NODE_REPLACE};
+    int indices[][2] = {{0, 0}, {1, 2}, {32767, 32768}, {100000, 70000}, {max_index, max_index}, {max_index - 1, 0}};
+    for (auto type : types)
+    {
+        for (auto index : indices)
+        {
+            OpData decoded(OpData(type, index[0], index[1]).toInt());
+            assert(decoded.m_type == type);
+            assert(decoded.m_first_idx == index[0]);
+            assert(decoded.m_second_idx == index[1]);
+        }
+    }
+
+    const int max_target = (1 << 28) - 1;
+    int or_opt_indices[][2] = {{0, 0}, {5, 2}, {max_index, max_target}, {max_target, 0}};
+    for (auto index : or_opt_indices)
+    {
+        for (int length = 1; length <= MAX_SEGMENT_LENGTH; ++length)
+        {
+            for (bool reversed : {false, true})
+            {
+                OpData decoded(OpData(OperationType::OR_OPT, index[0], index[1], length, reversed).toInt());
+                assert(decoded.m_type == OperationType::OR_OPT);
+                assert(decoded.m_first_idx == index[0]);
+                assert(decoded.m_second_idx == index[1]);
+                assert(decoded.m_length == length);
+                assert(decoded.m_reversed == reversed);
+            }
+        }
+    }
+}
+
+void testCompactOperationEncodingRoundTrip()
+{
+    const int max_index = (1 << 15) - 1;
+    OperationType types[] = {OperationType::NODE_SWAP, OperationType::EDGE_SWAP, OperationType::NODE_REPLACE};
+    int indices[][2] = {{0, 0}, {1, 2}, {255, 256}, {max_index, max_index}, {max_index - 1, 0}};
+    for (auto type : types)
+    {
+        for (auto index : indices)
+        {
+            OpData decoded = OpData::fromCompact(OpData(type, index[0], index[1]).toCompact());
+            assert(decoded.m_type == type);
+            assert(decoded.m_first_idx == index[0]);
+            assert(decoded.m_second_idx == index[1]);
+        }
+    }
+
+    const int max_target = (1 << 12) - 1;
+    int or_opt_indices[][2] = {{0, 0}, {5, 2}, {max_index, max_target}, {max_target, 0}};
+    for (auto index : or_opt_indices)
+    {
+        for (int length = 1; length <= MAX_SEGMENT_LENGTH; ++length)
+        {
+            for (bool reversed : {false, true})
+            {
+                OpData decoded = OpData::fromCompact(OpData(OperationType::OR_OPT, index[0], index[1], length, reversed).toCompact());
+                assert(decoded.m_type == OperationType::OR_OPT);
+                assert(decoded.m_first_idx == index[0]);
+                assert(decoded.m_second_idx == index[1]);
+                assert(decoded.m_length == length);
+                assert(decoded.m_reversed == reversed);
+            }
+        }
+    }
+
+    assert(fitsCompactOperation(max_index, max_index, NeighborhoodType::BOTH));
+    assert(!fitsCompactOperation(100, max_index + 1, NeighborhoodType::EDGE));
+    assert(fitsCompactOperation(max_target, max_index, NeighborhoodType::OR_OPT));
+    assert(!fitsCompactOperation(max_target + 1, max_index, NeighborhoodType::OR_OPT));
+}
+
+void testSteepestAllocatesNothingPerAppliedMove()
+{
+    NodesDistPair nodes(randomNodes(60, 1));
+    NeighborhoodType types[] = {NeighborhoodType::NODE, NeighborhoodType::EDGE, NeighborhoodType::BOTH};
+    for (auto type : types)
+    {
+        Solution solution = {0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 1, 6, 11, 16, 21, 26, 31, 36, 41, 46, 51, 56};
+        Solution start = solution;
+        SteepestImprover improver(type, 1, true);
+
+        std::size_t before = allocation_count;
+        improver.improve(solution, nodes);
+        std::size_t descent_allocations = allocation_count - before;
+        assert(solution != start);
+
+        // a second run starts in a local optimum and applies no move at all
+        before = allocation_count;
+        improver.improve(solution, nodes);
+        std::size_t setup_allocations = allocation_count - before;
+        assert(descent_allocations == setup_allocations);
+
+        // the move cache sizes itself from the improving moves of the start tour, so its
+        // descent is counted from the end of the setup
+        TourState state(strideTour(400, 157), 400);
+        NodesDistPair large(randomNodes(400, 2));
+        MoveCache cache(state, large, type);
+        int steps = 0;
+        before = allocation_count;
+        for (OpData op = cache.bestMove(state); !op.isInvalid(); op = cache.bestMove(state))
+        {
+            cache.apply(state, op);
+            ++steps;
+        }
+        assert(steps > 100);
+        assert(allocation_count == before);
+    }
+}
+
+void testSteepestReachesLocalOptimum()
+{
+    NodesDistPair nodes(randomNodes(120, 5));
+    Solution start = strideTour(120, 43);
+
+    NeighborhoodType types[] = {NeighborhoodType::NODE, NeighborhoodType::EDGE, NeighborhoodType::BOTH};
+    for (auto type : types)
+    {
+        // without the move cache the same neighborhood is searched by the full scan
+        for (bool full_scan : {false, true})
+        {
+            Solution solution = start;
+            SteepestImprover(type, 1, full_scan).improve(solution, nodes);
+            assert(evaluateSolution(nodes.nodes, solution) < evaluateSolution(nodes.nodes, start));
+            assertLocalOptimum(solution, nodes, type);
+        }
+    }
+
+    Solution solution = start;
+    SteepestSimplePrioritizingImprover(NeighborhoodType::EDGE).improve(solution, nodes);
+    assertLocalOptimum(solution, nodes, NeighborhoodType::EDGE);
+}
+
+void testMoveCacheMatchesFullScan()
+{
+    // points of a coarse grid with few distinct weights tie on many moves
+    Nodes grid;
+    std::mt19937 rng(11);
+    for (int i = 0; i < 150; ++i)
+    {
+        grid.emplace_back(rng() % 12 * 10, rng() % 12 * 10, rng() % 3);
+    }
+    NodesDistPair nodes(grid);
+
+    NeighborhoodType types[] = {NeighborhoodType::NODE, NeighborhoodType::EDGE, NeighborhoodType::BOTH};
+    for (auto type : types)
+    {
+        for (int stride : {7, 31, 61})
+        {
+            Solution cached = strideTour(150, stride);
+            Solution scanned = cached;
+            SteepestImprover(type).improve(cached, nodes);
+            SteepestImprover(type, 1, true).improve(scanned, nodes);
+            assert(cached == scanned);
+        }
+    }
+}
+
+void testGreedyReachesLocalOptimum()
+{
+    NodesDistPair nodes(randomNodes(120, 6));
+    Solution start = strideTour(120, 43);
+
+    for (auto type : {NeighborhoodType::NODE, NeighborhoodType::BOTH})
+    {
+        Solution solution = start;
+        Rng rng(5);
+        GreedyImprover(type, rng).improve(solution, nodes);
+        assertDistinctNodes(solution, start.size());
+        assertLocalOptimum(solution, nodes, type);
+
+        // all draws come from the given engine, so the same seed gives the same tour
+        Solution repeated = start;
+        Rng same_seed(5);
+        GreedyImprover(type, same_seed).improve(repeated, nodes);
+        assert(repeated == solution);
+    }
+}
+
+void testOrOptImproversReachLocalOptimum()
+{
+    NodesDistPair nodes(randomNodes(80, 3));
+    Solution start = strideTour(80, 31);
+
+    Solution solution = start;
+    SteepestImprover improver(NeighborhoodType::OR_OPT);
+    improver.improve(solution, nodes);
+    int score = evaluateSolution(nodes.nodes, solution);
+    assert(score < evaluateSolution(nodes.nodes, start));
+
+    // an or-opt optimum is also an edge swap optimum
+    Solution after_edges = solution;
+    SteepestImprover(NeighborhoodType::EDGE).improve(after_edges, nodes);
+    assert(after_edges == solution);
+
+    Solution candidate_solution = start;
+    SteepestCandidateImprover(NeighborhoodType::OR_OPT, 10).improve(candidate_solution, nodes);
+    assert(evaluateSolution(nodes.nodes, candidate_solution) < evaluateSolution(nodes.nodes, start));
+    assertDistinctNodes(candidate_solution, start.size());
+}
+
+void testThreadedSteepestMatchesSingleThreaded()
+{
+    NodesDistPair nodes(randomNodes(150, 7));
+    Solution start = strideTour(150, 37);
+
+    Solution single = start;
+    SteepestImprover(NeighborhoodType::OR_OPT).improve(single, nodes);
+    for (int num_threads : {2, 3, 5})
+    {
+        Solution threaded = start;
+        SteepestImprover(NeighborhoodType::OR_OPT, num_threads).improve(threaded, nodes);
+        assert(threaded == single);
+    }
+}
+
+void testImproverUsesThreads()
+{
+    assert(improverUsesThreads('s', NeighborhoodType::OR_OPT));
+    assert(!improverUsesThreads('s', NeighborhoodType::EDGE));
+    assert(!improverUsesThreads('s', NeighborhoodType::BOTH));
+    assert(improverUsesThreads('m', NeighborhoodType::EDGE));
+    assert(improverUsesThreads('e', NeighborhoodType::EDGE));
+    assert(!improverUsesThreads('c', NeighborhoodType::OR_OPT));
+}
+
+void testParallelMultipleStartMatchesSequential()
+{
+    NodesDistPair nodes(randomNodes(100, 8));
+    Solution start(50);
+    Rng rng;
+    for (char improver_type : {'g', 's'})
+    {
+        Solution sequential = start;
+        sequential = MultipleStartImprover(NeighborhoodType::BOTH, improver_type, 0, rng, 3, 6).improve(sequential, nodes);
+        for (int num_threads : {2, 4})
+        {
+            Solution parallel = start;
+            parallel = MultipleStartImprover(NeighborhoodType::BOTH, improver_type, 0, rng, 3, 6, num_threads).improve(parallel, nodes);
+            assert(parallel == sequential);
+        }
+    }
+}
+
+void testGeneticIslandsReturnValidSolution()
+{
+    NodesDistPair nodes(randomNodes(80, 9));
+    Solution start(40);
+    std::iota(start.begin(), start.end(), 0);
+    int start_cost = evaluateSolution(nodes.nodes, start);
+    Rng rng;
+    for (int num_islands : {1, 3})
+    {
+        Solution solution = start;
+        GeneticLocalSearchImprover improver(NeighborhoodType::EDGE, 'p', 0, rng, 50000, 6, num_islands, 2);
+        solution = improver.improve(solution, nodes);
+        assertDistinctNodes(solution, start.size());
+        assert(evaluateSolution(nodes.nodes, solution) < start_cost);
+        assert(std::stoi(improver.additionalInfo()) >= num_islands);
+    }
+
+    // children are improved by an improver that cannot be created, on every island
+    bool thrown = false;
+    try
+    {
+        Solution solution = start;
+        GeneticLocalSearchImprover(NeighborhoodType::EDGE, 'z', 0, rng, 50000, 6, 3, 2).improve(solution, nodes);
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void testDontLookBitsReachesLocalOptimum()
+{
+    NodesDistPair nodes(randomNodes(300, 2));
+    Solution start = strideTour(300, 37);
+
+    // the array tour and the two-level list
+    for (int two_level_size : {1000, 0})
+    {
+        Solution solution = start;
+        DontLookBitsImprover improver(NeighborhoodType::EDGE, 10, two_level_size);
+        improver.improve(solution, nodes);
+        assertDistinctNodes(solution, start.size());
+        assert(evaluateSolution(nodes.nodes, solution) < evaluateSolution(nodes.nodes, start));
+
+        // no candidate move is left, so a second run keeps the tour
+        Solution optimum = solution;
+        improver.improve(solution, nodes);
+        assert(solution == optimum);
+    }
+}
+
+void testVariableDepthReachesLocalOptimum()
+{
+    NodesDistPair nodes(randomNodes(300, 4));
+    Solution start = strideTour(300, 37);
+
+    Solution solution = start;
+    VariableDepthImprover improver(NeighborhoodType::EDGE, 10);
+    improver.improve(solution, nodes);
+    assertDistinctNodes(solution, start.size());
+    assert(evaluateSolution(nodes.nodes, solution) < evaluateSolution(nodes.nodes, start));
+
+    // every single improving candidate move is a chain of length one
+    Solution after_bits = solution;
+    DontLookBitsImprover(NeighborhoodType::EDGE, 10).improve(after_bits, nodes);
+    assert(after_bits == solution);
+}
+
+int main()
+{
+    testOperationEncodingRoundTrip();
+    testCompactOperationEncodingRoundTrip();
+    testSteepestAllocatesNothingPerAppliedMove();
+    testSteepestReachesLocalOptimum();
+    testMoveCacheMatchesFullScan();
+    testGreedyReachesLocalOptimum();
+    testOrOptImproversReachLocalOptimum();
+    testThreadedSteepestMatchesSingleThreaded();
+    testImproverUsesThreads();
+    testParallelMultipleStartMatchesSequential();
+    testGeneticIslandsReturnValidSolution();
+    testDontLookBitsReachesLocalOptimum();
+    testVariableDepthReachesLocalOptimum();
+}
@@ -0,0 +1,95 @@
+#include <cassert>
+#include <functional>
+#include <random>
+#include "indexed_heap.hpp"
+
+void testIndexedHeapPopsInPriorityOrder()
+{
+    IndexedHeap<int> heap(6);
+    int priorities[] = {5, 3, 9, 1, 7, 3};
+    for (int key = 0; key < 6; ++key)
+    {
+        heap.update(key, priorities[key]);
+    }
+    int expected[] = {3, 1, 5, 0, 4, 2};
+    for (int key : expected)
+    {
+        assert(heap.top() == key);
+        heap.pop();
+    }
+    assert(heap.empty());
+}
+
+void testIndexedHeapUpdateAndErase()
+{
+    IndexedHeap<int, std::greater<int>> heap(5);
+    for (int key = 0; key < 5; ++key)
+    {
+        heap.update(key, key * 10);
+    }
+    assert(heap.top() == 4);
+    heap.update(1, 100);
+    assert(heap.top() == 1);
+    assert(heap.topPriority() == 100);
+    heap.update(1, -5);
+    heap.erase(4);
+    assert(!heap.contains(4));
+    assert(heap.size() == 4);
+    assert(heap.top() == 3);
+    heap.update(0, 30);
+    // equal priorities are ordered by key
+    assert(heap.top() == 0);
+    heap.clear();
+    assert(heap.empty());
+    assert(!heap.contains(0));
+}
+
+void testSparseIndexedHeapMatchesIndexedHeap()
+{
+    // the same operations on spread out keys, with enough erasures to move keys back in
+    // their probe runs and enough keys to grow the table
+    const int num_keys = 500;
+    const long long spread = 1000000007LL;
+    IndexedHeap<int> dense(num_keys);
+    SparseIndexedHeap<int> sparse;
+    std::mt19937 rng(3);
+    for (int step = 0; step < 20000; ++step)
+    {
+        int key = rng() % num_keys;
+        if (rng() % 3 == 0)
+        {
+            dense.erase(key);
+            sparse.erase(key * spread);
+        }
+        else
+        {
+            int priority = rng() % 50;
+            dense.update(key, priority);
+            sparse.update(key * spread, priority);
+        }
+        assert(dense.size() == sparse.size());
+        assert(dense.contains(key) == sparse.contains(key * spread));
+        if (!dense.empty())
+        {
+            assert(dense.top() * spread == sparse.top());
+            assert(dense.topPriority() == sparse.topPriority());
+        }
+    }
+    while (!dense.empty())
+    {
+        assert(dense.top() * spread == sparse.top());
+        dense.pop();
+        sparse.pop();
+    }
+    assert(sparse.empty());
+    sparse.update(7, 1);
+    sparse.clear();
+    assert(!sparse.contains(7));
+}
+
+int main()
+{
+    testIndexedHeapPopsInPriorityOrder();
+    testIndexedHeapUpdateAndErase();
+    testSparseIndexedHeapMatchesIndexedHeap();
+}
@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include "node.hpp"
@@ -45,8 +46,33 @@ void testNodesReadCorrectlyFromFile()
     std::remove("test_nodes.csv");
 }
 
+void testDistanceMatrixIsSymmetricAndAligned()
+{
+    Nodes nodes = {
+        {0, 0, 1},
+        {10, 0, 2},
+        {5, 5, 0}};
+    DistanceMatrix dist = calculateDistanceMatrix(nodes);
+    assert(dist.size() == 3);
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        auto row = dist[i];
+        assert(row.size() == 3);
+        assert(reinterpret_cast<std::uintptr_t>(row.data()) % DistanceMatrix::ALIGNMENT == 0);
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            assert(row[j] == nodes[i].distanceTo(nodes[j]));
+            assert(row[j] == dist[j][i]);
+        }
+    }
+
+    DistanceMatrix copy = dist;
+    assert(copy[2][1] == 7);
+}
+
 int main()
 {
     testNodeDistancesCalculatedCorrectly();
     testNodesReadCorrectlyFromFile();
+    testDistanceMatrixIsSymmetricAndAligned();
 }
\ No newline at end of file
@@ -1,16 +1,20 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <iterator>
 #include "random.hpp"
 
 void testShuffledIndicesZeroSizeReturnsEmpty()
 {
 
-    auto rng = std::default_random_engine{};
+    Rng rng;
     assert(shuffledIndices(0, rng).empty());
 }
 
 void testShuffledIndicesReturnsVectorOfGivenSize()
 {
-    auto rng = std::default_random_engine{};
+    Rng rng;
     int tested_sizes[] = {5, 10, 20, 100};
     for (auto size : tested_sizes)
     {
@@ -20,7 +24,7 @@ void testShuffledIndicesReturnsVectorOfGivenSize()
 
 void testShuffledIndicesReturnsEveryIndex()
 {
-    auto rng = std::default_random_engine{};
+    Rng rng;
 
     int tested_sizes[] = {5, 10, 20, 100};
 
@@ -35,9 +39,146 @@ void testShuffledIndicesReturnsEveryIndex()
     }
 }
 
+void testRngIsReproducibleAfterSeeding()
+{
+    Rng first(7);
+    Rng second;
+    second.seed(7);
+    for (int i = 0; i < 100; ++i)
+    {
+        assert(first() == second());
+    }
+    assert(Rng(1)() != Rng(2)());
+}
+
+void testRngBelowStaysInRangeAndCoversIt()
+{
+    Rng rng(3);
+    std::uint64_t bounds[] = {1, 2, 3, 10, 1000};
+    for (auto bound : bounds)
+    {
+        std::vector<int> seen(bound, 0);
+        for (int i = 0; i < 20000; ++i)
+        {
+            std::uint64_t value = rng.below(bound);
+            assert(value < bound);
+            ++seen[value];
+        }
+        assert(std::find(seen.begin(), seen.end(), 0) == seen.end());
+    }
+    for (int i = 0; i < 1000; ++i)
+    {
+        assert(rng.below(std::uint64_t(1) << 63) < (std::uint64_t(1) << 63));
+    }
+}
+
+void testRngSplitGivesSeparateStreams()
+{
+    Rng rng(11);
+    Rng copy = rng;
+    Rng stream = rng.split();
+    // the split off stream continues the original one, which has jumped ahead
+    for (int i = 0; i < 100; ++i)
+    {
+        auto value = copy();
+        assert(stream() == value);
+    }
+    Rng jumped(11);
+    jumped.jump();
+    assert(rng() == jumped());
+
+    std::vector<std::uint64_t> first(64);
+    std::vector<std::uint64_t> second(64);
+    for (int i = 0; i < 64; ++i)
+    {
+        first[i] = stream();
+        second[i] = rng();
+    }
+    std::sort(first.begin(), first.end());
+    std::sort(second.begin(), second.end());
+    std::vector<std::uint64_t> common;
+    std::set_intersection(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(common));
+    assert(common.empty());
+}
+
+void testWeightedSamplerFollowsWeights()
+{
+    Rng rng(5);
+    std::vector<int> weights = {1, 0, 3, 6, 0, 10};
+    WeightedSampler sampler;
+    sampler.assign(weights);
+    assert(sampler.total() == 20);
+
+    const int draws = 200000;
+    std::vector<int> counts(weights.size(), 0);
+    for (int i = 0; i < draws; ++i)
+    {
+        ++counts[sampler.sample(rng)];
+    }
+    for (std::size_t i = 0; i < weights.size(); ++i)
+    {
+        double expected = static_cast<double>(draws) * weights[i] / 20;
+        assert(std::abs(counts[i] - expected) <= 0.02 * draws);
+        assert(weights[i] != 0 || counts[i] == 0);
+    }
+
+    sampler.set(5, 0);
+    sampler.set(1, 4);
+    assert(sampler.total() == 14);
+    for (int i = 0; i < 1000; ++i)
+    {
+        assert(sampler.sample(rng) != 5);
+    }
+}
+
+void testSampleWeightedWithoutReplacement()
+{
+    Rng rng(9);
+    std::vector<int> weights(50);
+    for (int i = 0; i < 50; ++i)
+    {
+        weights[i] = i % 7 + 1;
+    }
+    std::vector<int> samples = sampleWeightedWithoutReplacement(weights, 30, rng);
+    assert(samples.size() == 30);
+    std::vector<int> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    assert(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    for (int sample : samples)
+    {
+        assert(weights[sample] == 0);
+    }
+
+    // the first draw of each sample follows the weights
+    std::vector<int> small = {1, 3};
+    int first_heavy = 0;
+    for (int i = 0; i < 40000; ++i)
+    {
+        std::vector<int> copy = small;
+        first_heavy += sampleWeightedWithoutReplacement(copy, 2, rng)[0] == 1;
+    }
+    assert(std::abs(first_heavy - 30000) < 800);
+
+    bool thrown = false;
+    try
+    {
+        sampleWeightedWithoutReplacement(weights, 51, rng);
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
 int main()
 {
     testShuffledIndicesZeroSizeReturnsEmpty();
     testShuffledIndicesReturnsVectorOfGivenSize();
     testShuffledIndicesReturnsEveryIndex();
+    testRngIsReproducibleAfterSeeding();
+    testRngBelowStaysInRangeAndCoversIt();
+    testRngSplitGivesSeparateStreams();
+    testWeightedSamplerFollowsWeights();
+    testSampleWeightedWithoutReplacement();
 }
\ No newline at end of file
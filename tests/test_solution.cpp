@@ -125,6 +125,18 @@ void testSwapEdges()
     assert(swapEdges(s1, 1, 3) == swapEdges(s2, 3, 1));
 }
 
+void testMoveSegment()
+{
+    Solution solution = {0, 1, 2, 3, 4, 5};
+    Solution expected_1 = {0, 3, 1, 2, 4, 5};
+    Solution expected_2 = {0, 3, 4, 5, 2, 1};
+    Solution expected_3 = {3, 4, 0, 5, 2, 1};
+
+    assert(moveSegment(solution, 1, 2, 3, false) == expected_1);
+    assert(moveSegment(solution, 2, 2, 5, true) == expected_2);
+    assert(moveSegment(solution, 0, 1, 2, false) == expected_3);
+}
+
 int main()
 {
     testExportSolutionToFile();
@@ -134,4 +146,5 @@ int main()
     testReplaceNode();
     testSwapNodes();
     testSwapEdges();
+    testMoveSegment();
 }
\ No newline at end of file
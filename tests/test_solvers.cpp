@@ -0,0 +1,81 @@
+#include <cassert>
+#include <random>
+#include "solvers.hpp"
+
+static Nodes randomNodes(int size, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    Nodes nodes;
+    for (int i = 0; i < size; ++i)
+    {
+        int x = rng() % 100;
+        int y = rng() % 100;
+        nodes.emplace_back(x, y, rng() % 50);
+    }
+    return nodes;
+}
+
+void testIncrementalGreedyCycleMatchesExhaustive()
+{
+    // small coordinate range produces plenty of ties
+    for (unsigned int seed : {1, 2, 3})
+    {
+        NodesDistPair nodes(randomNodes(120, seed));
+        for (int start_idx : {0, 7, 63})
+        {
+            GreedyCycleSolver incremental(true);
+            GreedyCycleSolver exhaustive(false);
+            assert(incremental.solve(nodes, start_idx, 60) == exhaustive.solve(nodes, start_idx, 60));
+        }
+    }
+}
+
+void testIncrementalGreedyCycleMatchesExhaustiveFromStartingSolution()
+{
+    NodesDistPair nodes(randomNodes(100, 4));
+    Solution partial = {5, 17, 3, 42, 99, 61, 8};
+    GreedyCycleSolver incremental(true);
+    GreedyCycleSolver exhaustive(false);
+    incremental.setStartingSolution(partial);
+    exhaustive.setStartingSolution(partial);
+    Solution solution = incremental.solve(nodes, 0, 50);
+    assert(solution.size() == 50);
+    assert(solution == exhaustive.solve(nodes, 0, 50));
+}
+
+void testIncrementalTwoRegretMatchesExhaustive()
+{
+    double weights[][2] = {{1.0, 1.0}, {0.5, 1.5}, {1.5, 0.5}};
+    for (unsigned int seed : {5, 6})
+    {
+        NodesDistPair nodes(randomNodes(120, seed));
+        for (auto weight : weights)
+        {
+            for (int start_idx : {0, 31})
+            {
+                GreedyTwoRegretSolver incremental(weight[0], weight[1], true);
+                GreedyTwoRegretSolver exhaustive(weight[0], weight[1], false);
+                assert(incremental.solve(nodes, start_idx, 60) == exhaustive.solve(nodes, start_idx, 60));
+            }
+        }
+    }
+}
+
+void testIncrementalTwoRegretMatchesExhaustiveFromStartingSolution()
+{
+    NodesDistPair nodes(randomNodes(100, 7));
+    Solution partial = {12, 40, 3, 77, 58};
+    GreedyTwoRegretSolver incremental(1.0, 1.0, true);
+    GreedyTwoRegretSolver exhaustive(1.0, 1.0, false);
+    incremental.setStartingSolution(partial);
+    exhaustive.setStartingSolution(partial);
+    assert(incremental.solve(nodes, 0, 70) == exhaustive.solve(nodes, 0, 70));
+}
+
+int main()
+{
+    testIncrementalGreedyCycleMatchesExhaustive();
+    testIncrementalGreedyCycleMatchesExhaustiveFromStartingSolution();
+    testIncrementalTwoRegretMatchesExhaustive();
+    testIncrementalTwoRegretMatchesExhaustiveFromStartingSolution();
+}
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include "spatial_index.hpp"
+
+static Nodes randomNodes(int size, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    Nodes nodes;
+    for (int i = 0; i < size; ++i)
+    {
+        int x = rng() % 60;
+        int y = rng() % 60;
+        int weight = static_cast<int>(rng() % 40) - 10;
+        nodes.emplace_back(x, y, weight);
+    }
+    return nodes;
+}
+
+static std::vector<std::pair<int, int>> bruteForceRanking(const Nodes &nodes, int from, const std::vector<bool> &excluded)
+{
+    std::vector<std::pair<int, int>> ranking;
+    for (int j = 0; j < nodes.size(); ++j)
+    {
+        if (j != from && !excluded[j])
+        {
+            ranking.push_back({nodes[from].distanceTo(nodes[j]) + nodes[j].getWeight(), j});
+        }
+    }
+    std::sort(ranking.begin(), ranking.end());
+    return ranking;
+}
+
+void testKNearestMatchesSortedScan()
+{
+    Nodes nodes = randomNodes(300, 1);
+    SpatialIndex index(nodes);
+    std::vector<bool> none(nodes.size(), false);
+    for (int i = 0; i < nodes.size(); i += 7)
+    {
+        auto ranking = bruteForceRanking(nodes, i, none);
+        for (int k : {1, 5, 20})
+        {
+            std::vector<int> nearest = index.kNearest(i, k);
+            assert(nearest.size() == k);
+            for (int j = 0; j < k; ++j)
+            {
+                assert(nearest[j] == ranking[j].second);
+            }
+        }
+    }
+}
+
+void testNearestActiveSkipsDeactivatedNodes()
+{
+    Nodes nodes = randomNodes(200, 2);
+    SpatialIndex index(nodes);
+    std::vector<bool> inactive(nodes.size(), false);
+    std::mt19937 rng(3);
+    int current = 0;
+    index.deactivate(current);
+    inactive[current] = true;
+    for (int step = 0; step < 150; ++step)
+    {
+        int expected = bruteForceRanking(nodes, current, inactive).front().second;
+        int found = index.nearestActive(current);
+        assert(found == expected);
+        index.deactivate(found);
+        inactive[found] = true;
+        if (step % 10 == 0)
+        {
+            // reactivating keeps the subtree bounds consistent
+            int node = rng() % nodes.size();
+            if (node != found)
+            {
+                index.activate(node);
+                inactive[node] = false;
+            }
+        }
+        current = found;
+    }
+}
+
+void testNearestActiveReturnsNoneWhenExhausted()
+{
+    Nodes nodes = randomNodes(3, 4);
+    SpatialIndex index(nodes);
+    index.deactivate(1);
+    index.deactivate(2);
+    assert(index.nearestActive(0) == -1);
+    assert(index.nearestActive(1) == 0);
+}
+
+int main()
+{
+    testKNearestMatchesSortedScan();
+    testNearestActiveSkipsDeactivatedNodes();
+    testNearestActiveReturnsNoneWhenExhausted();
+}
@@ -0,0 +1,57 @@
+#include <cassert>
+#include <thread>
+#include "spsc_queue.hpp"
+
+void testSpscQueueKeepsOrderAndCapacity()
+{
+    SpscQueue<int> queue(3);
+    int value = 0;
+    assert(!queue.tryPop(value));
+    assert(queue.tryPush(1));
+    assert(queue.tryPush(2));
+    assert(queue.tryPush(3));
+    assert(!queue.tryPush(4));
+    assert(queue.tryPop(value) && value == 1);
+    assert(queue.tryPush(4));
+    assert(queue.tryPop(value) && value == 2);
+    assert(queue.tryPop(value) && value == 3);
+    assert(queue.tryPop(value) && value == 4);
+    assert(!queue.tryPop(value));
+}
+
+void testSpscQueueAcrossThreads()
+{
+    const int count = 100000;
+    SpscQueue<int> queue(8);
+    std::thread producer([&]
+                         {
+        for (int i = 0; i < count; ++i)
+        {
+            while (!queue.tryPush(i))
+            {
+                std::this_thread::yield();
+            }
+        } });
+
+    int expected = 0;
+    int value;
+    while (expected < count)
+    {
+        if (queue.tryPop(value))
+        {
+            assert(value == expected);
+            ++expected;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
+
+int main()
+{
+    testSpscQueueKeepsOrderAndCapacity();
+    testSpscQueueAcrossThreads();
+}
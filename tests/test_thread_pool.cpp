@@ -0,0 +1,41 @@
+#include <atomic>
+#include <cassert>
+#include <vector>
+#include "thread_pool.hpp"
+
+void testThreadPoolRunsEveryTaskOnce()
+{
+    for (int num_threads : {1, 2, 4})
+    {
+        ThreadPool pool(num_threads);
+        assert(pool.size() == num_threads);
+        for (int num_tasks : {0, 1, 7, 100})
+        {
+            std::vector<std::atomic<int>> runs(num_tasks);
+            pool.run(num_tasks, [&](int task)
+                     { ++runs[task]; });
+            for (const auto &count : runs)
+            {
+                assert(count == 1);
+            }
+        }
+    }
+}
+
+void testThreadPoolIsReusable()
+{
+    ThreadPool pool(3);
+    std::atomic<long long> sum = 0;
+    for (int round = 0; round < 200; ++round)
+    {
+        pool.run(10, [&](int task)
+                 { sum += task; });
+    }
+    assert(sum == 200 * 45);
+}
+
+int main()
+{
+    testThreadPoolRunsEveryTaskOnce();
+    testThreadPoolIsReusable();
+}
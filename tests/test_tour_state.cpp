@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cassert>
+#include "tour_state.hpp"
+
+static void assertConsistent(const TourState &state)
+{
+    int inside = 0;
+    for (int node = 0; node < state.numNodes(); ++node)
+    {
+        if (state.contains(node))
+        {
+            assert(state[state.position(node)] == node);
+            assert(state.outsideSlot(node) == TourState::OUTSIDE);
+            ++inside;
+        }
+        else
+        {
+            assert(state.position(node) == TourState::OUTSIDE);
+            assert(state.outsideNodes()[state.outsideSlot(node)] == node);
+        }
+    }
+    assert(inside == state.size());
+    assert(state.outsideNodes().size() == state.numNodes() - state.size());
+}
+
+void testTourStateInitialization()
+{
+    TourState state({3, 1, 4, 0, 5}, 9);
+    assert((state.tour() == Solution{3, 1, 4, 0, 5}));
+    assert((state.outsideNodes() == std::vector<int>{2, 6, 7, 8}));
+    assert(state.position(4) == 2);
+    assert(!state.contains(7));
+    assertConsistent(state);
+}
+
+void testTourStateFollowsMoves()
+{
+    Solution solution = {3, 1, 4, 0, 5, 7};
+    TourState state(solution, 10);
+
+    state.swapNodes(0, 4);
+    swapNodes(solution, 0, 4);
+    assert(state.tour() == solution);
+    assertConsistent(state);
+
+    state.swapEdges(4, 1);
+    swapEdges(solution, 4, 1);
+    assert(state.tour() == solution);
+    assertConsistent(state);
+
+    state.swapEdges(1, 3);
+    swapEdges(solution, 1, 3);
+    assert(state.tour() == solution);
+    assertConsistent(state);
+
+    state.moveSegment(3, 2, 0, true);
+    moveSegment(solution, 3, 2, 0, true);
+    assert(state.tour() == solution);
+    assertConsistent(state);
+
+    state.moveSegment(0, 3, 4, false);
+    moveSegment(solution, 0, 3, 4, false);
+    assert(state.tour() == solution);
+    assertConsistent(state);
+
+    state.replaceNode(2, 8);
+    replaceNode(solution, 2, 8);
+    assert(state.tour() == solution);
+    assert((state.outsideNodes() == std::vector<int>{2, 6, 5, 9}));
+    assertConsistent(state);
+}
+
+static bool sameCycle(const Solution &first, const Solution &second)
+{
+    Solution rotated = second;
+    for (int reversed = 0; reversed < 2; ++reversed)
+    {
+        for (int shift = 0; shift < rotated.size(); ++shift)
+        {
+            std::rotate(rotated.begin(), rotated.begin() + 1, rotated.end());
+            if (rotated == first)
+            {
+                return true;
+            }
+        }
+        std::reverse(rotated.begin(), rotated.end());
+    }
+    return false;
+}
+
+void testTourStateReversesShorterSide()
+{
+    Solution solution = {0, 1, 2, 3, 4, 5, 6, 7};
+    TourState state(solution, 9);
+
+    // the inner side has six nodes, the outer side 7 and 0 is reversed instead
+    state.swapEdges(0, 6);
+    swapEdges(solution, 0, 6);
+    assert((state.tour() == Solution{7, 1, 2, 3, 4, 5, 6, 0}));
+    assert(sameCycle(state.tour(), solution));
+    assertConsistent(state);
+
+    // positions only name the same edges while both arrays agree
+    solution = state.tour();
+    state.swapEdges(6, 1);
+    swapEdges(solution, 6, 1);
+    assert(sameCycle(state.tour(), solution));
+    assertConsistent(state);
+
+    assert(state.next(state[7]) == state[0]);
+    assert(state.prev(state[0]) == state[7]);
+    assert(state.between(state[6], state[7], state[1]));
+    assert(!state.between(state[1], state[7], state[6]));
+}
+
+int main()
+{
+    testTourStateInitialization();
+    testTourStateFollowsMoves();
+    testTourStateReversesShorterSide();
+}
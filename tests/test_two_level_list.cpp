@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include "two_level_list.hpp"
+#include "tour_state.hpp"
+
+static bool sameCycle(const Solution &first, const Solution &second)
+{
+    Solution rotated = second;
+    for (int reversed = 0; reversed < 2; ++reversed)
+    {
+        for (int shift = 0; shift < rotated.size(); ++shift)
+        {
+            std::rotate(rotated.begin(), rotated.begin() + 1, rotated.end());
+            if (rotated == first)
+            {
+                return true;
+            }
+        }
+        std::reverse(rotated.begin(), rotated.end());
+    }
+    return false;
+}
+
+static void assertConsistent(const TwoLevelList &list)
+{
+    Solution tour = list.tour();
+    assert(tour.size() == list.size());
+    for (int i = 0; i < tour.size(); ++i)
+    {
+        int next = tour[(i + 1) % tour.size()];
+        assert(list.contains(tour[i]));
+        assert(list.next(tour[i]) == next);
+        assert(list.prev(next) == tour[i]);
+    }
+    for (int node : list.outsideNodes())
+    {
+        assert(!list.contains(node));
+    }
+    assert(list.outsideNodes().size() == list.numNodes() - list.size());
+}
+
+void testTwoLevelListInitialization()
+{
+    Solution solution = {3, 1, 4, 0, 5, 9, 2, 6, 11, 10, 12, 13, 14, 15, 16, 17, 18, 19};
+    TwoLevelList list(solution, 22);
+    assert(list.tour() == solution);
+    assert((list.outsideNodes() == std::vector<int>{7, 8, 20, 21}));
+    assert(list.next(19) == 3);
+    assert(list.prev(3) == 19);
+    assert(list.between(3, 0, 6));
+    assert(!list.between(6, 0, 3));
+    assert(list.between(18, 1, 4));
+    assertConsistent(list);
+}
+
+void testTwoLevelListReversesPaths()
+{
+    Solution solution = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+    TwoLevelList list(solution, 20);
+
+    list.reversePath(2, 5);
+    assert(sameCycle(list.tour(), {0, 1, 5, 4, 3, 2, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19}));
+    assertConsistent(list);
+
+    list.reversePath(6, 17);
+    assert(sameCycle(list.tour(), {0, 1, 5, 4, 3, 2, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 18, 19}));
+    assertConsistent(list);
+
+    // the list may hold the cycle in either direction, but next, prev and between
+    // have to agree on the one it holds
+    bool forward = list.next(2) == 17;
+    assert(list.prev(17) == (forward ? 2 : 16));
+    assert(list.next(17) == (forward ? 16 : 2));
+    assert(list.next(6) == (forward ? 18 : 7));
+    assert(list.prev(18) == (forward ? 6 : 19));
+    assert(list.between(17, 10, 6) == forward);
+    assert(list.between(6, 10, 17) != forward);
+}
+
+void testTwoLevelListMatchesTourState()
+{
+    const int num_nodes = 300;
+    std::mt19937 rng(17);
+    std::vector<int> order(num_nodes);
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    Solution solution(order.begin(), order.begin() + 200);
+
+    TwoLevelList list(solution, num_nodes);
+    TourState state(solution, num_nodes);
+    for (int step = 0; step < 3000; ++step)
+    {
+        Solution tour = list.tour();
+        int first = tour[rng() % tour.size()];
+        int second = tour[rng() % tour.size()];
+        if (rng() % 4 == 0)
+        {
+            int inserted = list.outsideNodes()[rng() % list.outsideNodes().size()];
+            list.replace(first, inserted);
+            state.replace(first, inserted);
+        }
+        else
+        {
+            // both hold the same cycle but maybe in opposite directions, in which case
+            // the path from first to second of one is the path from second to first
+            // of the other
+            bool same_direction = list.next(first) == state.next(first);
+            list.reversePath(first, second);
+            if (same_direction)
+            {
+                state.reversePath(first, second);
+            }
+            else
+            {
+                state.reversePath(second, first);
+            }
+        }
+        if (step % 50 == 0)
+        {
+            assertConsistent(list);
+        }
+        assert(sameCycle(list.tour(), state.tour()));
+
+        tour = list.tour();
+        int a = rng() % tour.size();
+        int b = rng() % tour.size();
+        int c = rng() % tour.size();
+        bool expected = (b - a + tour.size()) % tour.size() <= (c - a + tour.size()) % tour.size();
+        assert(list.between(tour[a], tour[b], tour[c]) == expected);
+    }
+}
+
+int main()
+{
+    testTwoLevelListInitialization();
+    testTwoLevelListReversesPaths();
+    testTwoLevelListMatchesTourState();
+}